@@ -55,9 +55,63 @@ extern "C" {
 #endif
 
 /* macro -------------------------------------------------------------------- */
-#define BOS_MS_NUM_30DAY                (2592000000U)
-#define BOS_MS_NUM_15DAY                (1296000000U)
+#define BOS_MS_NUM_MAX                  (0x7fffffffU) /* About 24.8 days */
 #define BOS_STACK_MIN                   (16)        /* 16 words */
+#define STACK_SIZE_PUSH                 (64)        /* Pushed in PendSV */
+
+/* More than 32 priorities need the two-level ready bitmap. */
+#if (BOS_MAX_PRIORITY > 31)
+#define BOS_READY_WORDS                 ((BOS_MAX_PRIORITY / 32) + 1)
+#endif
+
+/* The start and the end of the task table in the task_rom section. */
+#if defined(__CC_ARM) || defined(__CLANG_ARM)
+extern const int task_rom$$Base;
+extern const int task_rom$$Limit;
+#define BOS_TASK_TABLE_START            ((bos_task_rom_t *)&task_rom$$Base)
+#define BOS_TASK_TABLE_END              ((bos_task_rom_t *)&task_rom$$Limit)
+#elif defined(__IAR_SYSTEMS_ICC__)
+#pragma section = "task_rom"
+#define BOS_TASK_TABLE_START            ((bos_task_rom_t *)__section_begin("task_rom"))
+#define BOS_TASK_TABLE_END              ((bos_task_rom_t *)__section_end("task_rom"))
+#elif defined(__GNUC__)
+extern const bos_task_rom_t __start_task_rom[];
+extern const bos_task_rom_t __stop_task_rom[];
+#define BOS_TASK_TABLE_START            ((bos_task_rom_t *)__start_task_rom)
+#define BOS_TASK_TABLE_END              ((bos_task_rom_t *)__stop_task_rom)
+#endif
+
+/* The time is reached or not, it works across the wrap of the 32-bit time. */
+#define BOS_TIME_REACHED(_time)         ((int32_t)(bos.time - (_time)) >= 0)
+#define BOS_TIME_BEFORE(_time, _ref)    ((int32_t)((_time) - (_ref)) < 0)
+
+/* The time to measure the timer callbacks, in micro-second if possible. */
+#if (BOS_USE_TIMER_SERVICE != 0)
+#if (BOS_USE_TIME_US != 0)
+#define BOS_TIMER_EXEC_TIME()           bos_cpu_time_us()
+#else
+#define BOS_TIMER_EXEC_TIME()           bos_time()
+#endif
+#endif
+
+/* The task at one position of the shared stack, and the reverse. */
+#if (BOS_USE_STACK_LAYOUT != 0)
+#define BOS_SLOT(task)                  ((task)->slot)
+#define BOS_SLOT_TASK(slot)             (bos.slot_task[slot])
+#else
+#define BOS_SLOT(task)                  ((task)->task_id)
+#define BOS_SLOT_TASK(slot)             (bos.task[slot])
+#endif
+
+/* Count leading zeros, ARMv7-M and later have the CLZ instruction. */
+#if defined(__CC_ARM) && (defined(__TARGET_ARCH_7_M) || defined(__TARGET_ARCH_7E_M))
+#define BOS_CLZ(x)                      __clz(x)
+#elif defined(__IAR_SYSTEMS_ICC__) && defined(__ARM_FEATURE_CLZ)
+#include <intrinsics.h>
+#define BOS_CLZ(x)                      __CLZ(x)
+#elif defined(__GNUC__) && defined(__ARM_FEATURE_CLZ)
+#define BOS_CLZ(x)                      __builtin_clz(x)
+#endif
 
 /* bos task ----------------------------------------------------------------- */
 /* Basic task state */
@@ -72,20 +126,104 @@ enum
     BosTaskState_Max,
 };
 
+#if (BOS_TIMER_POOL_SIZE != 0)
+/* The timer created in runtime, with its information in RAM. */
+typedef struct bos_timer_pool
+{
+    bos_timer_rom_t info;
+    bos_timer_t data;
+} bos_timer_pool_t;
+#endif
+
 typedef struct basic_os_tag
 {
     bos_task_rom_t *task_table;
     bos_timer_rom_t *timer_table;
     uint16_t task_count;
     uint16_t timer_count;
+
+    /* RAM copies of the task table, indexed by the task ID. */
+    bos_task_t *task[BOS_MAX_TASKS];
+    uint8_t priority[BOS_MAX_TASKS];
     void *stack;
     uint16_t stack_size;
     bool timer_cb_runing;
+#if (BOS_USE_TIMER_HARD != 0)
+    bool timer_hard_runing;
+#endif
+    bool idle_running;
+
+#if (BOS_USE_EDF == 0)
+#if (BOS_MAX_PRIORITY > 31)
+    /* Two-level ready bitmap, bit n of the group is set when the word n of
+       the priority bitmap is not zero. */
+    uint32_t ready_group;
+    uint32_t ready_priority[BOS_READY_WORDS];
+#else
+    /* Ready priority bitmap, bit n is set when priority n has ready tasks. */
+    uint32_t ready_priority;
+#endif
+    /* Ready task ring of every priority, pointing to the next one to run. */
+    bos_task_t *ready_ring[BOS_MAX_PRIORITY + 1];
+#else
+    /* Ready task list in the order of deadline. */
+    bos_task_t *ready_list;
+#endif
+
+#if (BOS_USE_TIMER_SERVICE != 0)
+    /* The task running the timer callbacks. */
+    bos_task_t *timer_service;
+#endif
+
+#if (BOS_TIMER_POOL_SIZE != 0)
+    /* Timers created in runtime, with the IDs from BOS_MAX_TIMERS on. The
+       free ones are in a stack of their pool indexes. */
+    bos_timer_pool_t timer_pool[BOS_TIMER_POOL_SIZE];
+    uint16_t timer_pool_free[BOS_TIMER_POOL_SIZE];
+    uint16_t timer_pool_free_count;
+#endif
+
+#if (BOS_USE_NAME_HASH != 0)
+    /* Name hash tables with linear probing, keeping the ID plus 1 and 0 for
+       the empty entry. */
+    uint16_t task_hash[BOS_NAME_HASH_SIZE];
+    uint16_t timer_hash[BOS_NAME_HASH_SIZE];
+#endif
+
+#if (BOS_USE_TIMER_HARD != 0)
+    /* Running hard timers in the order of timeout, linked by the next field. */
+    bos_timer_t *timer_hard_list;
+#endif
+
+#if (BOS_TIMER_DOMAINS > 1)
+    /* The time and the running timers in the order of timeout of every time
+       domain. The entries of domain 0 are not used. */
+    uint32_t domain_time[BOS_TIMER_DOMAINS];
+    bos_timer_t *domain_list[BOS_TIMER_DOMAINS];
+    bool domain_ticked;
+#endif
+
+    /* Running timers in a binary min-heap keyed on the timeout. */
+    bos_timer_t *timer_heap[BOS_MAX_TIMERS + BOS_TIMER_POOL_SIZE];
+    uint16_t timer_heap_count;
+
+    /* Blocked task list in the order of timeout, linked by the next field. */
+    bos_task_t *sleep_list;
+
+#if (BOS_USE_STACK_LAYOUT != 0)
+    /* The tasks in the order of the shared stack. */
+    bos_task_t *slot_task[BOS_MAX_TASKS];
+    uint32_t layout_time;
+    uint32_t layout_copy_size;
+    uint32_t layout_switch_count;
+    bos_layout_info_t layout_info;
+#endif
 
     uint32_t time_idle_backup;
     uint32_t time;
-    uint32_t time_out_min;
-    uint32_t time_offset;
+    uint32_t time_switch;
+    uint32_t time_slice;
+    uint32_t time_high;
     uint32_t cpu_usage_count;
 } basic_os_t;
 
@@ -101,12 +239,84 @@ bos_task_t *volatile bos_next;
 /* private variables -------------------------------------------------------- */
 static basic_os_t bos;
 static uint32_t stack_used = 0;
+#if (BOS_USE_MOVE_COST != 0)
+static uint32_t move_saved = 0;
+#endif
+#if (BOS_USE_TIMER_SLACK != 0)
+static uint32_t wakeup_saved = 0;
+#endif
+#if (BOS_USE_STACK_LAYOUT != 0)
+/* Switching counts between every two tasks, [low task id][high task id]. */
+static uint16_t switch_count[BOS_MAX_TASKS][BOS_MAX_TASKS];
+#endif
 
 /* private function --------------------------------------------------------- */
 static void bos_sheduler(void);
 static void bos_start(void);
-static bool bos_check_timer(bool task_idle);
-static void _entry_idle(void *parameter);
+static void bos_task_set_state(bos_task_t *task, uint8_t state);
+static void bos_ready_add(bos_task_t *task);
+static void bos_ready_remove(bos_task_t *task);
+static void bos_ready_add_next(bos_task_t *task);
+#if (BOS_USE_MOVE_COST != 0)
+static bos_task_t *bos_sheduler_min_move(uint32_t priority);
+#endif
+#if (BOS_USE_STACK_LAYOUT != 0)
+static void bos_stack_layout(void);
+#endif
+#if (BOS_USE_EDF == 0) || (BOS_USE_TIMER_STAT != 0) || (BOS_USE_TIMER_SLACK != 0)
+static uint32_t bos_bit_last(uint32_t value);
+#endif
+#if (BOS_USE_EDF == 0)
+static uint32_t bos_ready_highest(void);
+#endif
+static bool bos_check_timer(void);
+static bool bos_timer_run(void);
+static void bos_timer_call(bos_timer_t *timer, const bos_timer_rom_t *info);
+static void bos_timer_reload(bos_timer_t *timer, const bos_timer_rom_t *info,
+                             uint32_t now);
+#if (BOS_USE_TIMER_HARD != 0)
+static void bos_timer_hard_run(void);
+#endif
+#if (BOS_USE_TIMER_HARD != 0) || (BOS_TIMER_DOMAINS > 1)
+static bos_timer_t **bos_timer_list_of(bos_timer_t *timer,
+                                       const bos_timer_rom_t *info);
+static void bos_timer_list_add(bos_timer_t **list, bos_timer_t *timer);
+static void bos_timer_list_remove(bos_timer_t **list, bos_timer_t *timer);
+#endif
+#if (BOS_TIMER_DOMAINS > 1)
+static bool bos_timer_domain_run(void);
+#endif
+#if (BOS_USE_TIMER_SERVICE != 0)
+static bool bos_timer_due(void);
+static bool bos_timer_service_wakeup(void);
+#endif
+#if (BOS_USE_TIMER_SERVICE != 0) || (BOS_USE_TIMER_STAT != 0)
+static void bos_timer_stat_init(bos_timer_t *timer);
+#endif
+#if (BOS_USE_TIMER_STAT != 0)
+static void bos_timer_stat_late(bos_timer_t *timer, uint32_t late);
+#endif
+#if (BOS_USE_NAME_HASH != 0)
+static uint32_t bos_name_hash(const char *name);
+static void bos_name_hash_add(uint16_t *table, const char *name, uint16_t id);
+#endif
+static const bos_timer_rom_t *bos_timer_info(uint16_t timer_id);
+#if (BOS_USE_TIMER_SERVICE != 0)
+static void bos_timer_service(void *para);
+#endif
+static bool bos_task_wakeup(void);
+static void bos_sleep_add(bos_task_t *task);
+static void bos_idle(void);
+#if (BOS_USE_TICKLESS != 0)
+static void bos_idle_sleep(void);
+#endif
+static void bos_timer_heap_add(bos_timer_t *timer);
+#if (BOS_USE_TIMER_SLACK != 0)
+static uint32_t bos_timer_align(uint32_t time, uint32_t slack);
+#endif
+static void bos_timer_heap_remove(bos_timer_t *timer);
+static void bos_timer_heap_up(uint32_t index);
+static void bos_timer_heap_down(uint32_t index);
 static void _cb_timer_tick(void *para);
 
 /* public function ---------------------------------------------------------- */
@@ -114,14 +324,14 @@ void bos_critical_enter(void);
 void bos_critical_exit(void);
 uint32_t get_sp_value(void);
 
-/* Default task and timer --------------------------------------------------- */
-/*  Note 1
-    Although the priority of idle task is set to be 1. But the program in 
-    bos_sheduler() makes the actual priority of idle task is 0.
-*/
-bos_task_export(task_timer, _entry_idle, 1, NULL);
+/* Default timer ------------------------------------------------------------ */
 bos_timer_export(basic_timer, _cb_timer_tick, false, NULL);
 
+#if (BOS_USE_TIMER_SERVICE != 0)
+/* Timer service task ------------------------------------------------------- */
+bos_task_export(timer_service, bos_timer_service, BOS_TIMER_SERVICE_PRIORITY, NULL);
+#endif
+
 /* public function ---------------------------------------------------------- */
 /**
   * @brief  BasicOS stack and tasks initialization.
@@ -139,45 +349,46 @@ void basic_os_init(void *stack, uint32_t size)
     uint32_t mod = (uint32_t)stack % 8;
     bos.stack = mod == 0 ? stack : (void *)((uint32_t)stack + 8 - mod);
     size = (((uint32_t)bos.stack + size - mod) / 8) * 8 - (uint32_t)bos.stack;
+    BOS_ASSERT((size / 4) <= UINT16_MAX);
     bos.stack_size = size / 4;
 
     /* Get the task table and its counting number. */
-    bos.task_table = (bos_task_rom_t *)&rom_task_task_timer;
-    bos_task_rom_t *task_temp = NULL;
-    while (1)
-    {
-        task_temp =
-            (bos_task_rom_t *)((uint32_t)bos.task_table - sizeof(bos_task_rom_t));
-        if (task_temp->magic_head != EXPORT_ID_TASK ||
-            task_temp->magic_tail != EXPORT_ID_TASK)
-        {
-            break;
-        }
-        
-        bos.task_table = task_temp;
-    }
-    bos.task_count = 0;
+    bos.task_table = BOS_TASK_TABLE_START;
+    bos.task_count = BOS_TASK_TABLE_END - BOS_TASK_TABLE_START;
+    BOS_ASSERT(bos.task_count != 0 && bos.task_count <= BOS_MAX_TASKS);
     bos.timer_cb_runing = false;
+#if (BOS_USE_TIMER_HARD != 0)
+    bos.timer_hard_runing = false;
+#endif
+    bos.idle_running = false;
+#if (BOS_USE_EDF == 0)
+#if (BOS_MAX_PRIORITY > 31)
+    bos.ready_group = 0;
+    memset(bos.ready_priority, 0, sizeof(bos.ready_priority));
+#else
+    bos.ready_priority = 0;
+#endif
+    memset(bos.ready_ring, 0, sizeof(bos.ready_ring));
+#else
+    bos.ready_list = NULL;
+#endif
     uint32_t task_id_high_prio = 0;
+#if (BOS_USE_EDF == 0)
     uint8_t priority = 0;
-    for (uint32_t i = 0; ; i ++)
+#endif
+    for (uint32_t i = 0; i < bos.task_count; i ++)
     {
-        if (bos.task_table[i].magic_head == EXPORT_ID_TASK &&
-            bos.task_table[i].magic_tail == EXPORT_ID_TASK)
-        {
-            if (bos.task_table[i].priority > priority)
-            {
-                task_id_high_prio = i;
-                priority = bos.task_table[i].priority;
-            }
-            
-            // TODO Check the tasks' data is not repeated.
-            bos.task_count ++;
-        }
-        else
+        BOS_ASSERT(bos.task_table[i].magic_head == EXPORT_ID_TASK &&
+                   bos.task_table[i].magic_tail == EXPORT_ID_TASK);
+
+#if (BOS_USE_EDF == 0)
+        if (bos.task_table[i].priority > priority)
         {
-            break;
+            task_id_high_prio = i;
+            priority = bos.task_table[i].priority;
         }
+#endif
+        // TODO Check the tasks' data is not repeated.
     }
 
     /* Get the timer table and its counting number. */
@@ -203,6 +414,24 @@ void basic_os_init(void *stack, uint32_t size)
             bos.timer_table[i].magic_tail == EXPORT_ID_TIMER)
         {
             // TODO Check all timers' data is not repeated.
+            bos_timer_t *timer_data = (bos_timer_t *)bos.timer_table[i].data;
+            timer_data->id = i;
+            timer_data->running = 0;
+            timer_data->catchup = BosTimerCatchup_All;
+#if (BOS_TIMER_DOMAINS > 1)
+            BOS_ASSERT(bos.timer_table[i].domain < BOS_TIMER_DOMAINS);
+#if (BOS_USE_TIMER_HARD != 0)
+            /* Hard timers run in bos_tick(), so only in the kernel time. */
+            BOS_ASSERT(bos.timer_table[i].domain == 0 ||
+                       !bos.timer_table[i].hard);
+#endif
+            timer_data->domain = bos.timer_table[i].domain;
+#else
+            timer_data->domain = 0;
+#endif
+#if (BOS_USE_TIMER_SERVICE != 0) || (BOS_USE_TIMER_STAT != 0)
+            bos_timer_stat_init(timer_data);
+#endif
             bos.timer_count ++;
         }
         else
@@ -212,8 +441,55 @@ void basic_os_init(void *stack, uint32_t size)
     }
 
     bos.time = 0;
-    bos.time_offset = 0;
-    bos.time_out_min = UINT32_MAX;
+    bos.time_high = 0;
+    BOS_ASSERT(bos.timer_count <= BOS_MAX_TIMERS);
+
+#if (BOS_USE_NAME_HASH != 0)
+    /* Build the name hash tables, in the table order to find the first one of
+       the same names as the name comparing does. */
+    memset(bos.task_hash, 0, sizeof(bos.task_hash));
+    memset(bos.timer_hash, 0, sizeof(bos.timer_hash));
+    for (uint32_t i = 0; i < bos.task_count; i ++)
+    {
+        bos_name_hash_add(bos.task_hash, bos.task_table[i].name, i);
+    }
+    for (uint32_t i = 0; i < bos.timer_count; i ++)
+    {
+        bos_name_hash_add(bos.timer_hash, bos.timer_table[i].name, i);
+    }
+#endif
+
+    bos.timer_heap_count = 0;
+#if (BOS_USE_TIMER_HARD != 0)
+    bos.timer_hard_list = NULL;
+#endif
+#if (BOS_TIMER_DOMAINS > 1)
+    memset(bos.domain_time, 0, sizeof(bos.domain_time));
+    memset(bos.domain_list, 0, sizeof(bos.domain_list));
+    bos.domain_ticked = false;
+#endif
+#if (BOS_TIMER_POOL_SIZE != 0)
+    for (uint32_t i = 0; i < BOS_TIMER_POOL_SIZE; i ++)
+    {
+        bos.timer_pool[i].info.magic_head = 0;
+        bos.timer_pool[i].info.magic_tail = 0;
+        bos.timer_pool_free[i] = BOS_TIMER_POOL_SIZE - 1 - i;
+    }
+    bos.timer_pool_free_count = BOS_TIMER_POOL_SIZE;
+#endif
+#if (BOS_USE_TIMER_SERVICE != 0)
+    bos.timer_service = &ram_timer_service_data;
+#endif
+    bos.sleep_list = NULL;
+    bos.time_switch = 0;
+    bos.time_slice = bos.task_table[task_id_high_prio].time_slice;
+#if (BOS_USE_STACK_LAYOUT != 0)
+    bos.layout_time = 0;
+    bos.layout_copy_size = 0;
+    bos.layout_switch_count = 0;
+    memset(&bos.layout_info, 0, sizeof(bos.layout_info));
+    memset(switch_count, 0, sizeof(switch_count));
+#endif
     
     /* Get the highest priority task. */
     bos_current = NULL;
@@ -228,6 +504,12 @@ void basic_os_init(void *stack, uint32_t size)
     {
         task_data = (bos_task_t *)bos.task_table[i].data;
         task_data->task_id = i;
+        bos.task[i] = task_data;
+        bos.priority[i] = bos.task_table[i].priority;
+#if (BOS_USE_STACK_LAYOUT != 0)
+        task_data->slot = i;
+        bos.slot_task[i] = task_data;
+#endif
         task_info = (bos_task_rom_t *)&bos.task_table[i];
         task_data->stack_size = i == task_id_high_prio ? remaining : BOS_STACK_MIN;
         task_data->stack = stack_current;
@@ -238,9 +520,36 @@ void basic_os_init(void *stack, uint32_t size)
         
         /* save the top of the stack in the task's attibute */
         task_data->sp = bos_cpu_stack_init(task_info);
+        /* The initial frame fills the stack of the waiting task, with no free
+           space to be copied in the task switching. */
+        BOS_ASSERT(i == task_id_high_prio || task_data->sp == task_data->stack);
 
-        task_data->state = BosTaskState_Ready;
+        /* Stopped until it is added into the ready ring. */
+        task_data->state = BosTaskState_Stop;
         task_data->state_bkp = BosTaskState_Ready;
+#if (BOS_USE_EDF != 0)
+        task_data->deadline_relative = BOS_EDF_DEADLINE_DEFAULT;
+        task_data->deadline = BOS_EDF_DEADLINE_DEFAULT;
+        task_data->deadline_miss = 0;
+#endif
+#if (BOS_USE_TASK_PERIODIC != 0)
+        /* The first bos_task_wait_period() waits for the phase. */
+        BOS_ASSERT(task_info->period <= BOS_MS_NUM_MAX);
+        task_data->release = bos.time + task_info->phase - task_info->period;
+        task_data->jitter_last = 0;
+        task_data->jitter_max = 0;
+        task_data->release_count = 0;
+        task_data->release_miss = 0;
+#if (BOS_USE_EDF != 0)
+        /* The implicit deadline of one job is its next release. */
+        if (task_info->period != 0)
+        {
+            task_data->deadline_relative = task_info->period > UINT16_MAX ?
+                                           UINT16_MAX : task_info->period;
+        }
+#endif
+#endif
+        bos_task_set_state(task_data, BosTaskState_Ready);
     }
 
     bos_critical_exit();
@@ -265,15 +574,34 @@ void basic_os_run(void)
 
 /**
   * @brief  Get the BasicOS time in mili-second.
+  * @note   The value wraps around every 49.7 days, use bos_time64() for
+  *         the time which never wraps.
   * @retval BasicOS time in mili-second
   */
 uint32_t bos_time(void)
 {
-    bos_critical_enter();
-    uint32_t time_offset = bos.time_offset;
-    bos_critical_exit();
+    return *(volatile uint32_t *)&bos.time;
+}
+
+/**
+  * @brief  Get the 64-bit BasicOS time in mili-second, which never wraps.
+  * @retval BasicOS time in mili-second
+  */
+uint64_t bos_time64(void)
+{
+    volatile uint32_t *time_high = &bos.time_high;
+    volatile uint32_t *time = &bos.time;
+    uint32_t high;
+    uint32_t low;
+
+    /* Read again if bos_tick() wraps the low word meanwhile. */
+    do
+    {
+        high = *time_high;
+        low = *time;
+    } while (high != *time_high);
 
-    return (time_offset + bos.time);
+    return (((uint64_t)high << 32) | low);
 }
 
 /**
@@ -285,9 +613,51 @@ void bos_tick(void)
 {
     bos_critical_enter();
     bos.time += BOS_TICK_MS;
+    if (bos.time < BOS_TICK_MS)
+    {
+        bos.time_high ++;
+    }
+    bos_critical_exit();
+
+#if (BOS_USE_TIME_US != 0)
+    /* Keep the port micro-second time running across its counter wrap. */
+    (void)bos_cpu_time_us();
+#endif
+#if (BOS_USE_TIMER_HARD != 0)
+    bos_timer_hard_run();
+#endif
+}
+
+#if (BOS_TIMER_DOMAINS > 1)
+/**
+  * @brief  The tick function of one time domain. Please put it into the timer
+  *         ISR of the domain.
+  * @param  domain      The time domain, 1 at least.
+  * @retval None.
+  */
+void bos_tick_domain(uint8_t domain)
+{
+    BOS_ASSERT(domain != 0 && domain < BOS_TIMER_DOMAINS);
+
+    bos_critical_enter();
+    bos.domain_time[domain] ++;
+    bos.domain_ticked = true;
     bos_critical_exit();
 }
 
+/**
+  * @brief  Get the time of one time domain, in its ticks.
+  * @param  domain      The time domain, 1 at least.
+  * @retval The domain time.
+  */
+uint32_t bos_time_domain(uint8_t domain)
+{
+    BOS_ASSERT(domain != 0 && domain < BOS_TIMER_DOMAINS);
+
+    return bos.domain_time[domain];
+}
+#endif
+
 /**
   * @brief  The BasicOS delay function in the current thread.
   * @param  time_ms     Delayed time in mili-seconds.
@@ -297,6 +667,9 @@ void bos_tick(void)
 void bos_delay_ms(uint32_t time_ms)
 {
     BOS_ASSERT(!bos.timer_cb_runing);
+#if (BOS_USE_TIMER_HARD != 0)
+    BOS_ASSERT(!bos.timer_hard_runing);
+#endif
 
     if (time_ms == 0)
     {
@@ -304,48 +677,78 @@ void bos_delay_ms(uint32_t time_ms)
         return;
     }
     
-    BOS_ASSERT(time_ms <= BOS_MS_NUM_30DAY);
+    BOS_ASSERT(time_ms <= BOS_MS_NUM_MAX);
 
-    /* Never call bos_delay_ms in the idle task. */
-    BOS_ASSERT(bos_current != &ram_task_timer_data);
+    /* Never call bos_delay_ms in the idle hook. */
+    BOS_ASSERT(!bos.idle_running);
     
-    bos_task_t *task_data = NULL;
-    uint32_t count = 0;
     bos_critical_enter();
     bos_current->timeout = bos.time + time_ms;
-    bos_current->state = BosTaskState_Blocked;
-    for (uint32_t i = bos_current->task_id;;)
+#if (BOS_USE_EDF != 0)
+    /* The current job is done, check its deadline and set the next one. */
+    if ((int32_t)(bos.time - bos_current->deadline) > 0 &&
+        bos_current->deadline_miss < UINT16_MAX)
     {
-        task_data = (bos_task_t *)bos.task_table[i].data;
-        if (task_data != bos_current &&
-            bos.task_table[i].priority == bos.task_table[bos_current->task_id].priority &&
-            (task_data->state == BosTaskState_Suspended ||
-            task_data->state == BosTaskState_Ready))
-        {
-            task_data->state = BosTaskState_Ready;
-            break;
-        }
-
-        count ++;
-        i = (i + 1) % bos.task_count;
-        if (count >= bos.task_count)
-        {
-            break;
-        }
+        bos_current->deadline_miss ++;
     }
+    bos_current->deadline = bos_current->timeout + bos_current->deadline_relative;
+#endif
+    bos_task_set_state(bos_current, BosTaskState_Blocked);
+    bos_sleep_add(bos_current);
     bos_critical_exit();
     
     bos_sheduler();
 }
 
+#if (BOS_USE_TIME_US != 0)
+/**
+  * @brief  Get the BasicOS time in micro-second.
+  * @retval BasicOS time in micro-second
+  */
+uint32_t bos_time_us(void)
+{
+    return bos_cpu_time_us();
+}
+
+/**
+  * @brief  The BasicOS delay function in micro-second in the current thread.
+  *         The whole ticks are slept, only the rest is busy-waited.
+  * @param  time_us     Delayed time in micro-seconds.
+  * @note   It can NOT be used in the Idle hook function.
+  * @retval None.
+  */
+void bos_delay_us(uint32_t time_us)
+{
+    uint32_t time_start = bos_cpu_time_us();
+
+    /* The current tick is partly passed, so one tick less is slept. */
+    uint32_t time_ms = time_us / 1000;
+    if (time_ms > BOS_TICK_MS)
+    {
+        bos_delay_ms(time_ms - BOS_TICK_MS);
+    }
+
+    while ((bos_cpu_time_us() - time_start) < time_us)
+    {
+    }
+}
+#endif
+
 /**
   * @brief  The BasicOS terminate the current thread.
   * @retval None.
   */
 void bos_task_exit(void)
 {
+    /* Only from a task, not from the idle hook or a timer callback, which
+       may run in the context of a task which is not ready. */
+    BOS_ASSERT(!bos.timer_cb_runing);
+#if (BOS_USE_TIMER_HARD != 0)
+    BOS_ASSERT(!bos.timer_hard_runing);
+#endif
+    BOS_ASSERT(!bos.idle_running);
     bos_critical_enter();
-    bos_current->state = BosTaskState_Stop;
+    bos_task_set_state(bos_current, BosTaskState_Stop);
     bos_critical_exit();
     
     bos_sheduler();
@@ -360,37 +763,27 @@ void bos_task_exit(void)
   */
 void bos_task_yield(void)
 {
-    bos_task_t *task_data = NULL;
-
-    bos_check_timer(false);
+    BOS_ASSERT(!bos.timer_cb_runing);
+#if (BOS_USE_TIMER_HARD != 0)
+    BOS_ASSERT(!bos.timer_hard_runing);
+#endif
+    BOS_ASSERT(!bos.idle_running);
+    bos_check_timer();
     
     bos_critical_enter();
     
-    /* Find the next task in the same priority with the current task. */
-    uint8_t priority_current = bos.task_table[bos_current->task_id].priority;
-    bool found = false;
-    uint32_t count = 0;
-    for (uint32_t i = bos_current->task_id;;)
-    {
-        task_data = (bos_task_t *)bos.task_table[i].data;
-        if (task_data != bos_current &&
-            bos.task_table[i].priority == priority_current &&
-            (task_data->state == BosTaskState_Suspended ||
-            task_data->state == BosTaskState_Ready))
-        {
-            task_data->state = BosTaskState_Ready;
-            bos_current->state = BosTaskState_Suspended;
-            found = true;
-            break;
-        }
-
-        count ++;
-        i = (i + 1) % bos.task_count;
-        if (count >= bos.task_count)
-        {
-            break;
-        }
-    }
+#if (BOS_USE_EDF == 0)
+    /* Hand over to the next task in the same priority ring. */
+    uint32_t priority = bos.priority[bos_current->task_id];
+    bool found = (bos_current->next != bos_current ||
+                  bos_ready_highest() > priority);
+    bos.ready_ring[priority] = bos_current->next;
+#else
+    /* Queue behind the other tasks with the same deadline. */
+    bos_ready_remove(bos_current);
+    bos_ready_add(bos_current);
+    bool found = (bos.ready_list != bos_current);
+#endif
     bos_critical_exit();
 
     if (found)
@@ -399,231 +792,1267 @@ void bos_task_yield(void)
     }
 }
 
-/* Soft timer --------------------------------------------------------------- */
 /**
-  * @brief  Get the BasicOS timer's ID from its name.
-  * @retval Timer ID when positive or error id when negetive.
+  * @brief  Check if the current task should yield now, when a higher priority
+  *         task is ready, or the current task has run out of its time slice
+  *         and another task is waiting. It is cheap to call in long loops.
+  * @retval True if the current task should call bos_task_yield().
   */
-int16_t bos_timer_get_id(const char *name)
+bool bos_should_yield(void)
 {
-    /* Find the timer in the task table. */
-    int16_t ret = BOS_NOT_FOUND;
-    for (uint32_t i = 0; i < bos.timer_count; i ++)
+    BOS_ASSERT(!bos.timer_cb_runing);
+#if (BOS_USE_TIMER_HARD != 0)
+    BOS_ASSERT(!bos.timer_hard_runing);
+#endif
+    BOS_ASSERT(!bos.idle_running);
+    bool ret = false;
+    bool waiting = false;
+
+    bos_critical_enter();
+
+    /* Wake up the timeout tasks without running any timer. */
+    bos_task_wakeup();
+#if (BOS_USE_TIMER_SERVICE != 0)
+    /* The timer service is woken up as in bos_check_timer(), so it competes
+       with the current task. */
+    (void)bos_timer_service_wakeup();
+#endif
+
+#if (BOS_USE_EDF == 0)
+    uint32_t priority = bos.priority[bos_current->task_id];
+    ret = (bos_ready_highest() > priority);
+    waiting = (bos_current->next != bos_current);
+#else
+    ret = (bos.ready_list != bos_current);
+    waiting = (bos_current->next != NULL);
+#endif
+
+    if (!ret && waiting && bos.time_slice != 0 &&
+        (bos.time - bos.time_switch) >= bos.time_slice)
     {
-        if (strcmp(bos.timer_table[i].name, name) == 0)
-        {
-            ret = i;
-            break;
-        }
+        ret = true;
     }
 
+    bos_critical_exit();
+
     return ret;
 }
 
 /**
-  * @brief  Start one soft timer exported by bos_timer_export.
-  * @param  timer_id    The timer ID.
-  * @param  period      The soft-timer's period in mili-second.
+  * @brief  Switch to the given ready task directly, and the current task goes
+  *         back to the ready set. The priority rules still apply, so a higher
+  *         priority task runs before the given one. If the given task is not
+  *         ready, it works the same as bos_task_yield().
+  * @param  task_id     The task ID.
   * @retval None.
   */
-void bos_timer_start(uint16_t timer_id, uint32_t period)
+void bos_task_yield_to(uint16_t task_id)
 {
-    BOS_ASSERT(timer_id < bos.timer_count);
-    BOS_ASSERT(period <= BOS_MS_NUM_30DAY);
-
-    bos_critical_enter();
+    BOS_ASSERT(!bos.timer_cb_runing);
+#if (BOS_USE_TIMER_HARD != 0)
+    BOS_ASSERT(!bos.timer_hard_runing);
+#endif
+    BOS_ASSERT(!bos.idle_running);
+    BOS_ASSERT(task_id < bos.task_count);
 
-    bos_timer_t *timer = (bos_timer_t *)bos.timer_table[timer_id].data;
-    timer->running = 1;
-    timer->period = period;
+    bos_task_t *task = bos.task[task_id];
 
-    timer->timeout = bos.time + period;
-    if (timer->timeout < bos.time_out_min)
+    bos_check_timer();
+    
+    bos_critical_enter();
+    if (task != bos_current && task->state == BosTaskState_Ready)
     {
-        bos.time_out_min = timer->timeout;
+        bos_ready_remove(task);
+        bos_ready_add_next(task);
+#if (BOS_USE_MOVE_COST != 0)
+        /* Never passed over by the move-cost policy. */
+        task->skip_count = BOS_MOVE_COST_FAIR_LIMIT;
+#endif
     }
-    
-
     bos_critical_exit();
+
+    bos_task_yield();
 }
 
 /**
-  * @brief  Stop the soft timer exported by bos_timer_export.
-  * @param  timer_id    The timer ID.
-  * @retval None.
+  * @brief  Get the BasicOS task's ID from its name.
+  * @retval Task ID when positive or error id when negetive.
   */
-void bos_timer_stop(uint16_t timer_id)
+int16_t bos_task_get_id(const char *name)
 {
-    BOS_ASSERT(timer_id < bos.timer_count);
-    bos_timer_t *timer = NULL;
-    uint32_t time_out_min = UINT32_MAX;
-
-    bos_critical_enter();
+    int16_t ret = BOS_NOT_FOUND;
 
-    for (uint32_t i = 0; i < bos.timer_count; i ++)
+#if (BOS_USE_NAME_HASH != 0)
+    /* Probe the hash table until the name or an empty entry is found. */
+    uint32_t index = bos_name_hash(name) & (BOS_NAME_HASH_SIZE - 1);
+    while (bos.task_hash[index] != 0)
     {
-        timer = (bos_timer_t *)bos.timer_table[timer_id].data;
-        if (i == timer_id)
+        uint16_t id = bos.task_hash[index] - 1;
+        if (strcmp(bos.task_table[id].name, name) == 0)
         {
-            timer->running = 0;
+            ret = id;
+            break;
         }
-        else if (timer->running != 0 && time_out_min > timer->timeout)
+        index = (index + 1) & (BOS_NAME_HASH_SIZE - 1);
+    }
+#else
+    /* Find the task in the task table. */
+    for (uint32_t i = 0; i < bos.task_count; i ++)
+    {
+        if (strcmp(bos.task_table[i].name, name) == 0)
         {
-            time_out_min = timer->timeout;
+            ret = i;
+            break;
         }
     }
-    bos.time_out_min = time_out_min;
+#endif
 
-    bos_critical_exit();
+    return ret;
 }
 
+#if (BOS_USE_TASK_PERIODIC != 0)
 /**
-  * @brief  Re-start one soft timer exported by bos_timer_export.
-  * @param  timer_id    The timer ID.
-  * @param  period      The soft-timer's period in mili-second.
+  * @brief  Wait for the next release of the current periodic task, exported by
+  *         bos_task_export_periodic. Call it at the top of the task loop. If
+  *         the release has passed, the missed ones are skipped and it returns
+  *         at once.
   * @retval None.
   */
-void bos_timer_reset(uint16_t timer_id, uint32_t period)
+void bos_task_wait_period(void)
 {
-    BOS_ASSERT(timer_id < bos.timer_count);
-    BOS_ASSERT(period <= BOS_MS_NUM_30DAY);
+    BOS_ASSERT(!bos.timer_cb_runing);
+#if (BOS_USE_TIMER_HARD != 0)
+    BOS_ASSERT(!bos.timer_hard_runing);
+#endif
+    BOS_ASSERT(!bos.idle_running);
 
-    bos_critical_enter();
+    bos_task_t *task = bos_current;
+    uint32_t period = bos.task_table[task->task_id].period;
+    BOS_ASSERT(period != 0);
 
-    bos_timer_t *timer = (bos_timer_t *)bos.timer_table[timer_id].data;
-    timer->running = 1;
-    timer->period = period;
-    if (bos.time_out_min > timer->timeout)
+    bos_critical_enter();
+    uint32_t release = task->release + period;
+    int32_t late = (int32_t)(bos.time - release);
+    bool wait = (late < 0);
+    /* No job is done before the first release, so nothing is missed. */
+    bool first = (task->release_count == 0);
+    if (late > 0)
     {
-        bos.time_out_min = timer->timeout;
+        /* The job is not done before its next release. Skip the missed
+           releases, keeping the phase. */
+        if (!first)
+        {
+            task->release_miss ++;
+        }
+        release += ((uint32_t)late / period) * period;
     }
+    task->release = release;
+    task->release_count ++;
+    if (wait)
+    {
+        task->timeout = release;
+        bos_task_set_state(task, BosTaskState_Blocked);
+        bos_sleep_add(task);
+    }
+#if (BOS_USE_EDF != 0)
+    if (!first && (int32_t)(bos.time - task->deadline) > 0 &&
+        task->deadline_miss < UINT16_MAX)
+    {
+        task->deadline_miss ++;
+    }
+    /* A late task keeps ready, so it is moved out of the ready list while
+       its deadline changes, to keep the list in deadline order. */
+    if (!wait)
+    {
+        bos_ready_remove(task);
+    }
+    task->deadline = release + task->deadline_relative;
+    if (!wait)
+    {
+        bos_ready_add(task);
+    }
+#endif
+    bos_critical_exit();
+
+#if (BOS_USE_EDF != 0)
+    if (wait || bos.ready_list != task)
+#else
+    if (wait)
+#endif
+    {
+        bos_sheduler();
+    }
+
+    /* The jitter is how late the task runs after its release. */
+    bos_critical_enter();
+    uint32_t jitter = bos.time - task->release;
+    task->jitter_last = jitter > UINT16_MAX ? UINT16_MAX : jitter;
+    if (task->jitter_last > task->jitter_max)
+    {
+        task->jitter_max = task->jitter_last;
+    }
+    bos_critical_exit();
+}
+
+/**
+  * @brief  Get the release statistics of one periodic task.
+  * @param  task_id     The task ID.
+  * @param  stat        The periodic task statistics.
+  * @retval None.
+  */
+void bos_task_get_period_stat(uint16_t task_id, bos_task_period_stat_t *stat)
+{
+    BOS_ASSERT(task_id < bos.task_count);
+
+    bos_critical_enter();
+    bos_task_t *task = bos.task[task_id];
+    stat->release_count = task->release_count;
+    stat->release_miss = task->release_miss;
+    stat->jitter_last = task->jitter_last;
+    stat->jitter_max = task->jitter_max;
+    bos_critical_exit();
+}
+#endif
+
+#if (BOS_USE_EDF != 0)
+/**
+  * @brief  Set the relative deadline of the current task. The current job has
+  *         to be done in it from now, and every job later has to be done in it
+  *         from its waking up in bos_delay_ms.
+  * @param  deadline_ms The relative deadline in mili-second.
+  * @retval None.
+  */
+void bos_task_set_deadline(uint32_t deadline_ms)
+{
+    BOS_ASSERT(!bos.timer_cb_runing);
+#if (BOS_USE_TIMER_HARD != 0)
+    BOS_ASSERT(!bos.timer_hard_runing);
+#endif
+    BOS_ASSERT(!bos.idle_running);
+    BOS_ASSERT(deadline_ms <= UINT16_MAX);
+
+    bos_critical_enter();
+    bos_current->deadline_relative = deadline_ms;
+    bos_current->deadline = bos.time + deadline_ms;
+
+    /* Keep the ready list in deadline order. */
+    bos_ready_remove(bos_current);
+    bos_ready_add(bos_current);
+    bos_critical_exit();
+
+    if (bos.ready_list != bos_current)
+    {
+        bos_sheduler();
+    }
+}
+
+/**
+  * @brief  Get the deadline missing count of the task.
+  * @param  task_id     The task ID.
+  * @retval The deadline missing count.
+  */
+uint32_t bos_task_get_deadline_miss(uint16_t task_id)
+{
+    BOS_ASSERT(task_id < bos.task_count);
+
+    return (bos.task[task_id])->deadline_miss;
+}
+#endif
+
+/* Soft timer --------------------------------------------------------------- */
+/**
+  * @brief  Get the BasicOS timer's ID from its name.
+  * @retval Timer ID when positive or error id when negetive.
+  */
+int16_t bos_timer_get_id(const char *name)
+{
+    int16_t ret = BOS_NOT_FOUND;
+
+#if (BOS_USE_NAME_HASH != 0)
+    /* Probe the hash table until the name or an empty entry is found. */
+    uint32_t index = bos_name_hash(name) & (BOS_NAME_HASH_SIZE - 1);
+    while (bos.timer_hash[index] != 0)
+    {
+        uint16_t id = bos.timer_hash[index] - 1;
+        if (strcmp(bos.timer_table[id].name, name) == 0)
+        {
+            ret = id;
+            break;
+        }
+        index = (index + 1) & (BOS_NAME_HASH_SIZE - 1);
+    }
+#else
+    /* Find the timer in the task table. */
+    for (uint32_t i = 0; i < bos.timer_count; i ++)
+    {
+        if (strcmp(bos.timer_table[i].name, name) == 0)
+        {
+            ret = i;
+            break;
+        }
+    }
+#endif
+
+    return ret;
+}
+
+/**
+  * @brief  Start one soft timer exported by bos_timer_export.
+  * @param  timer_id    The timer ID.
+  * @param  period      The soft-timer's period in mili-second.
+  * @retval None.
+  */
+void bos_timer_start(uint16_t timer_id, uint32_t period)
+{
+    const bos_timer_rom_t *timer_info = bos_timer_info(timer_id);
+    BOS_ASSERT(period <= BOS_MS_NUM_MAX);
+    BOS_ASSERT(period != 0 || timer_info->oneshoot);
+
+    bos_critical_enter();
+
+    bos_timer_t *timer = (bos_timer_t *)timer_info->data;
+#if (BOS_TIMER_DOMAINS > 1)
+    uint32_t now = timer->domain == 0 ?
+                   bos.time : bos.domain_time[timer->domain];
+#else
+    uint32_t now = bos.time;
+#endif
+    timer->period = period;
+#if (BOS_USE_TIMER_SLACK != 0)
+    timer->expiry = now + period;
+    timer->timeout = bos_timer_align(timer->expiry, timer_info->slack);
+#else
+    timer->timeout = now + period;
+#endif
+#if (BOS_USE_TIMER_HARD != 0) || (BOS_TIMER_DOMAINS > 1)
+    bos_timer_t **list = bos_timer_list_of(timer, timer_info);
+    if (list != NULL)
+    {
+        if (timer->running != 0)
+        {
+            bos_timer_list_remove(list, timer);
+        }
+        timer->running = 1;
+        bos_timer_list_add(list, timer);
+        bos_critical_exit();
+        return;
+    }
+#endif
+    if (timer->running == 0)
+    {
+        timer->running = 1;
+        bos_timer_heap_add(timer);
+    }
+    else
+    {
+        /* The timeout may move both ways, fix its place in the heap. */
+        bos_timer_heap_up(timer->heap_index);
+        bos_timer_heap_down(timer->heap_index);
+    }
+
+    bos_critical_exit();
+}
+
+/**
+  * @brief  Stop the soft timer exported by bos_timer_export.
+  * @param  timer_id    The timer ID.
+  * @retval None.
+  */
+void bos_timer_stop(uint16_t timer_id)
+{
+    const bos_timer_rom_t *timer_info = bos_timer_info(timer_id);
+
+    bos_critical_enter();
+
+    bos_timer_t *timer = (bos_timer_t *)timer_info->data;
+    if (timer->running != 0)
+    {
+        timer->running = 0;
+#if (BOS_USE_TIMER_HARD != 0) || (BOS_TIMER_DOMAINS > 1)
+        bos_timer_t **list = bos_timer_list_of(timer, timer_info);
+        if (list != NULL)
+        {
+            bos_timer_list_remove(list, timer);
+        }
+        else
+#endif
+        {
+            bos_timer_heap_remove(timer);
+        }
+    }
+
+    bos_critical_exit();
+}
+
+/**
+  * @brief  Re-start one soft timer exported by bos_timer_export, its timeout
+  *         is counted from now again.
+  * @param  timer_id    The timer ID.
+  * @param  period      The soft-timer's period in mili-second.
+  * @retval None.
+  */
+void bos_timer_reset(uint16_t timer_id, uint32_t period)
+{
+    bos_timer_start(timer_id, period);
+}
+
+#if (BOS_TIMER_POOL_SIZE != 0)
+/**
+  * @brief  Create one soft timer from the timer pool. It is used as the timer
+  *         exported by bos_timer_export, by the returned ID.
+  * @param  func        The timer callback function.
+  * @param  oneshoot    One-shoot timer or periodic timer.
+  * @param  para        The timer paramter.
+  * @retval Timer ID when positive or BOS_NO_MEMORY when the pool is empty.
+  */
+int16_t bos_timer_create(bos_func_t func, bool oneshoot, void *para)
+{
+    BOS_ASSERT(func != NULL);
+
+    int16_t ret = BOS_NO_MEMORY;
+
+    bos_critical_enter();
+
+    if (bos.timer_pool_free_count != 0)
+    {
+        uint16_t index = bos.timer_pool_free[-- bos.timer_pool_free_count];
+        bos_timer_pool_t *timer = &bos.timer_pool[index];
+
+        timer->info.magic_head = EXPORT_ID_TIMER;
+        timer->info.func = func;
+        timer->info.name = NULL;
+        timer->info.parameter = para;
+        timer->info.data = (void *)&timer->data;
+        timer->info.oneshoot = oneshoot;
+#if (BOS_USE_TIMER_HARD != 0)
+        timer->info.hard = false;
+#endif
+#if (BOS_TIMER_DOMAINS > 1)
+        timer->info.domain = 0;
+#endif
+#if (BOS_USE_TIMER_SLACK != 0)
+        timer->info.slack = 0;
+#endif
+        timer->info.magic_tail = EXPORT_ID_TIMER;
+
+        timer->data.id = BOS_MAX_TIMERS + index;
+        timer->data.running = 0;
+        timer->data.catchup = BosTimerCatchup_All;
+        timer->data.domain = 0;
+#if (BOS_USE_TIMER_SERVICE != 0) || (BOS_USE_TIMER_STAT != 0)
+        bos_timer_stat_init(&timer->data);
+#endif
+        ret = BOS_MAX_TIMERS + index;
+    }
+
+    bos_critical_exit();
+
+    return ret;
+}
+
+/**
+  * @brief  Stop the soft timer created by bos_timer_create, and put it back
+  *         into the timer pool.
+  * @param  timer_id    The timer ID.
+  * @retval None.
+  */
+void bos_timer_delete(uint16_t timer_id)
+{
+    BOS_ASSERT(timer_id >= BOS_MAX_TIMERS);
+    bos_timer_pool_t *timer = &bos.timer_pool[timer_id - BOS_MAX_TIMERS];
+    BOS_ASSERT(bos_timer_info(timer_id) == &timer->info);
+
+    bos_critical_enter();
+
+    if (timer->data.running != 0)
+    {
+        timer->data.running = 0;
+        bos_timer_heap_remove(&timer->data);
+    }
+    timer->info.magic_head = 0;
+    timer->info.magic_tail = 0;
+    bos.timer_pool_free[bos.timer_pool_free_count ++] =
+        timer_id - BOS_MAX_TIMERS;
+
+    bos_critical_exit();
+}
+#endif
+
+/**
+  * @brief  Set what the periodic timer does after it has missed whole periods,
+  *         BosTimerCatchup_All by default.
+  * @param  timer_id    The timer ID.
+  * @param  catchup     The catch-up policy in enum bos_timer_catchup.
+  * @retval None.
+  */
+void bos_timer_set_catchup(uint16_t timer_id, uint8_t catchup)
+{
+    const bos_timer_rom_t *timer_info = bos_timer_info(timer_id);
+    BOS_ASSERT(catchup <= BosTimerCatchup_Realign);
+
+    bos_critical_enter();
+    ((bos_timer_t *)timer_info->data)->catchup = catchup;
+    bos_critical_exit();
+}
+
+#if (BOS_USE_TIMER_SERVICE != 0) || (BOS_USE_TIMER_STAT != 0)
+/**
+  * @brief  Get the statistics of one soft timer.
+  * @param  timer_id    The timer ID.
+  * @param  stat        The timer statistics.
+  * @retval None.
+  */
+void bos_timer_get_stat(uint16_t timer_id, bos_timer_stat_t *stat)
+{
+    const bos_timer_rom_t *timer_info = bos_timer_info(timer_id);
+
+    bos_critical_enter();
+    bos_timer_t *timer = (bos_timer_t *)timer_info->data;
+#if (BOS_USE_TIMER_SERVICE != 0)
+    stat->exec_last = timer->exec_last;
+    stat->exec_max = timer->exec_max;
+#endif
+#if (BOS_USE_TIMER_STAT != 0)
+    stat->late_min = timer->late_min;
+    stat->late_max = timer->late_max;
+    stat->overrun = timer->overrun;
+    memcpy(stat->late_hist, timer->late_hist, sizeof(stat->late_hist));
+#endif
+    bos_critical_exit();
+}
+
+/**
+  * @brief  Clear the statistics of one soft timer.
+  * @param  timer_id    The timer ID.
+  * @retval None.
+  */
+void bos_timer_clear_stat(uint16_t timer_id)
+{
+    const bos_timer_rom_t *timer_info = bos_timer_info(timer_id);
+
+    bos_critical_enter();
+    bos_timer_stat_init((bos_timer_t *)timer_info->data);
+    bos_critical_exit();
+}
+#endif
+
+/**
+  * @brief  Estimate the used stack size in the BasicOS kernel.
+  * @retval The used stack size.
+  */
+uint32_t bos_get_used_stack_size(void)
+{
+    return stack_used;
+}
+
+#if (BOS_USE_MOVE_COST != 0)
+/**
+  * @brief  Get the stack bytes not moved thanks to the move-cost policy,
+  *         compared with the plain round-robin order.
+  * @retval The saved bytes.
+  */
+uint32_t bos_get_move_saved_size(void)
+{
+    return move_saved;
+}
+#endif
+
+#if (BOS_USE_TIMER_SLACK != 0)
+/**
+  * @brief  Get the wakeups saved by the timer slack, counted as the timers
+  *         whose expiry is moved by the slack to the wakeup of other timers.
+  * @retval The saved wakeups.
+  */
+uint32_t bos_get_wakeup_saved(void)
+{
+    return wakeup_saved;
+}
+#endif
+
+#if (BOS_USE_STACK_LAYOUT != 0)
+/**
+  * @brief  Get the copied stack bytes per switch, before and after the last
+  *         stack layout adjustment.
+  * @param  info    The layout information.
+  * @retval None.
+  */
+void bos_get_layout_info(bos_layout_info_t *info)
+{
+    bos_critical_enter();
+    *info = bos.layout_info;
+    if (bos.layout_switch_count != 0)
+    {
+        info->copy_after = bos.layout_copy_size / bos.layout_switch_count;
+    }
+    bos_critical_exit();
+}
+#endif
+
+/* private function --------------------------------------------------------- */
+/**
+  * @brief  Check all thread timers and soft-timers are timeout or not.
+  * @retval If false, no task is woken up and no timer is timeout.
+  */
+static bool bos_check_timer(void)
+{
+    bool ret = false;
+    
+#if (BOS_TIMER_DOMAINS > 1)
+    if (bos.time_idle_backup != bos.time || bos.domain_ticked)
+#else
+    if (bos.time_idle_backup != bos.time)
+#endif
+    {
+        bos.time_idle_backup = bos.time;
+        
+        bos_critical_enter();
+#if (BOS_TIMER_DOMAINS > 1)
+        bos.domain_ticked = false;
+#endif
+
+        /* Wake up the timeout tasks at the head of the sleep list. The idle
+           loop has to switch to them at once, without the idle hook. */
+        ret = bos_task_wakeup();
+        
+#if (BOS_USE_TIMER_SERVICE != 0)
+        /* Only mark the timers expired, they run in the timer service. */
+        ret = bos_timer_service_wakeup() || ret;
+#else
+        ret = bos_timer_run() || ret;
+#endif
+
+        bos_critical_exit();
+    }
+    
+    return ret;
+}
+
+#if (BOS_USE_TIMER_SERVICE != 0)
+/**
+  * @brief  The timer service task. It runs the callbacks of the timeout
+  *         timers, and is suspended until the next timer is timeout.
+  * @param  para    Not used.
+  * @retval None.
+  */
+static void bos_timer_service(void *para)
+{
+    (void)para;
+
+    while (1)
+    {
+        bos_critical_enter();
+        bos_timer_run();
+        bos_task_set_state(bos_current, BosTaskState_Suspended);
+        bos_critical_exit();
+
+        bos_sheduler();
+    }
+}
+#endif
+
+/**
+  * @brief  Run the callbacks of the timeout timers at the top of the heap. It
+  *         is called in the critical section.
+  * @retval If false, no timer is timeout.
+  */
+static bool bos_timer_run(void)
+{
+    bool ret = false;
+    bos_timer_t *timer_data = NULL;
+#if (BOS_USE_TIMER_SLACK != 0)
+    uint32_t count_moved = 0;
+    bool count_own = false;
+#endif
+
+    while (bos.timer_heap_count != 0 &&
+           BOS_TIME_REACHED(bos.timer_heap[0]->timeout))
+    {
+        timer_data = bos.timer_heap[0];
+        const bos_timer_rom_t *timer_info = bos_timer_info(timer_data->id);
+
+#if (BOS_USE_TIMER_SLACK != 0)
+        /* The slack moved its expiry to this time, or it expires on time. */
+        if (timer_data->timeout != timer_data->expiry &&
+            (bos.time - timer_data->expiry) <= timer_info->slack)
+        {
+            count_moved ++;
+        }
+        else
+        {
+            count_own = true;
+        }
+#endif
+
+        /* Reschedule it before the callback, which may restart or stop
+           the timer again. */
+        bos_timer_reload(timer_data, timer_info, bos.time);
+        if (timer_info->oneshoot == 0)
+        {
+            bos_timer_heap_down(0);
+        }
+        else
+        {
+            timer_data->running = 0;
+            bos_timer_heap_remove(timer_data);
+        }
+
+        bos_timer_call(timer_data, timer_info);
+        ret = true;
+    }
+
+#if (BOS_USE_TIMER_SLACK != 0)
+    /* The moved timers run in the wakeup of the others, or in one wakeup for
+       all of them. */
+    if (count_moved != 0)
+    {
+        wakeup_saved += count_own ? count_moved : (count_moved - 1);
+    }
+#endif
+
+#if (BOS_TIMER_DOMAINS > 1)
+    if (bos_timer_domain_run())
+    {
+        ret = true;
+    }
+#endif
+
+    return ret;
+}
+
+/**
+  * @brief  Run the callback of one soft timer out of the critical section. It
+  *         is called in the critical section.
+  * @param  timer   The timer data.
+  * @param  info    The timer information.
+  * @retval None.
+  */
+static void bos_timer_call(bos_timer_t *timer, const bos_timer_rom_t *info)
+{
+    bos.timer_cb_runing = true;
+    bos_critical_exit();
+#if (BOS_USE_TIMER_SERVICE != 0)
+    uint32_t time_start = BOS_TIMER_EXEC_TIME();
+    info->func(info->parameter);
+    timer->exec_last = BOS_TIMER_EXEC_TIME() - time_start;
+    if (timer->exec_last > timer->exec_max)
+    {
+        timer->exec_max = timer->exec_last;
+    }
+#else
+    (void)timer;
+    info->func(info->parameter);
+#endif
+    bos_critical_enter();
+    bos.timer_cb_runing = false;
+}
+
+#if (BOS_TIMER_DOMAINS > 1)
+/**
+  * @brief  Run the callbacks of the timeout timers of all time domains. It is
+  *         called in the critical section.
+  * @retval If false, no timer is timeout.
+  */
+static bool bos_timer_domain_run(void)
+{
+    bool ret = false;
+
+    for (uint32_t i = 1; i < BOS_TIMER_DOMAINS; i ++)
+    {
+        while (bos.domain_list[i] != NULL &&
+               (int32_t)(bos.domain_time[i] - bos.domain_list[i]->timeout) >= 0)
+        {
+            bos_timer_t *timer = bos.domain_list[i];
+            const bos_timer_rom_t *info = bos_timer_info(timer->id);
 
-    bos_critical_exit();
+            bos.domain_list[i] = timer->next;
+            bos_timer_reload(timer, info, bos.domain_time[i]);
+            if (info->oneshoot == 0)
+            {
+                bos_timer_list_add(&bos.domain_list[i], timer);
+            }
+            else
+            {
+                timer->running = 0;
+            }
+
+            bos_timer_call(timer, info);
+            ret = true;
+        }
+    }
+
+    return ret;
 }
+#endif
 
+#if (BOS_USE_TIMER_SERVICE != 0)
 /**
-  * @brief  Estimate the used stack size in the BasicOS kernel.
-  * @retval The used stack size.
+  * @brief  Check any soft timer is timeout or not. It is called in the
+  *         critical section.
+  * @retval If false, no timer is timeout.
   */
-uint32_t bos_get_used_stack_size(void)
+static bool bos_timer_due(void)
 {
-    return stack_used;
+    if (bos.timer_heap_count != 0 &&
+        BOS_TIME_REACHED(bos.timer_heap[0]->timeout))
+    {
+        return true;
+    }
+#if (BOS_TIMER_DOMAINS > 1)
+    for (uint32_t i = 1; i < BOS_TIMER_DOMAINS; i ++)
+    {
+        if (bos.domain_list[i] != NULL &&
+            (int32_t)(bos.domain_time[i] - bos.domain_list[i]->timeout) >= 0)
+        {
+            return true;
+        }
+    }
+#endif
+
+    return false;
 }
 
-/* private function --------------------------------------------------------- */
 /**
-  * @brief  Check all thread timers and soft-timers are timeout or not.
-  * @param  task_idle   In idle thread or not.
-  * @retval If false, not timer is timeout.
+  * @brief  Make the timer service ready when any soft timer is timeout. It is
+  *         called in the critical section.
+  * @retval If false, the timer service is not made ready.
   */
-static bool bos_check_timer(bool task_idle)
+static bool bos_timer_service_wakeup(void)
 {
-    bool ret = false;
-    bos_timer_t *timer_data = NULL;
-    bos_task_t *task_data = NULL;
-    
-    if (bos.time_idle_backup != bos.time)
+    if (!bos_timer_due() ||
+        bos.timer_service->state != BosTaskState_Suspended)
     {
-        bos.time_idle_backup = bos.time;
-        
-        bos_critical_enter();
+        return false;
+    }
 
-        /* check all the task are timeout or not. */
-        bool task_timeout = false;
-        for (uint32_t i = 0; i < bos.task_count; i ++)
+#if (BOS_USE_EDF != 0)
+    /* A new job of the timer service, with its deadline from now. */
+    bos.timer_service->deadline =
+        bos.time + bos.timer_service->deadline_relative;
+#endif
+    bos_task_set_state(bos.timer_service, BosTaskState_Ready);
+
+    return true;
+}
+#endif
+
+#if (BOS_USE_NAME_HASH != 0)
+/**
+  * @brief  The FNV-1a hash of one name.
+  * @param  name    The task or timer name.
+  * @retval The hash value.
+  */
+static uint32_t bos_name_hash(const char *name)
+{
+    uint32_t hash = 2166136261U;
+    while (*name != 0)
+    {
+        hash ^= (uint8_t)*name ++;
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+/**
+  * @brief  Add one name into the hash table, at the first empty entry from
+  *         its hash.
+  * @param  table   The hash table.
+  * @param  name    The task or timer name.
+  * @param  id      The task or timer ID.
+  * @retval None.
+  */
+static void bos_name_hash_add(uint16_t *table, const char *name, uint16_t id)
+{
+    uint32_t index = bos_name_hash(name) & (BOS_NAME_HASH_SIZE - 1);
+    while (table[index] != 0)
+    {
+        index = (index + 1) & (BOS_NAME_HASH_SIZE - 1);
+    }
+    table[index] = id + 1;
+}
+#endif
+
+#if (BOS_USE_TIMER_SERVICE != 0) || (BOS_USE_TIMER_STAT != 0)
+/**
+  * @brief  Clear the statistics of the timer.
+  * @param  timer   The timer data.
+  * @retval None.
+  */
+static void bos_timer_stat_init(bos_timer_t *timer)
+{
+#if (BOS_USE_TIMER_SERVICE != 0)
+    timer->exec_last = 0;
+    timer->exec_max = 0;
+#endif
+#if (BOS_USE_TIMER_STAT != 0)
+    timer->late_min = UINT32_MAX;
+    timer->late_max = 0;
+    timer->overrun = 0;
+    memset(timer->late_hist, 0, sizeof(timer->late_hist));
+#endif
+}
+#endif
+
+#if (BOS_USE_TIMER_STAT != 0)
+/**
+  * @brief  Record the lateness of one timer expiry.
+  * @param  timer   The timer data.
+  * @param  late    The lateness in mili-second.
+  * @retval None.
+  */
+static void bos_timer_stat_late(bos_timer_t *timer, uint32_t late)
+{
+    if (late < timer->late_min)
+    {
+        timer->late_min = late;
+    }
+    if (late > timer->late_max)
+    {
+        timer->late_max = late;
+    }
+
+    uint32_t bucket = (late == 0) ? 0 : (bos_bit_last(late) + 1);
+    if (bucket >= BOS_TIMER_LATE_BUCKETS)
+    {
+        bucket = BOS_TIMER_LATE_BUCKETS - 1;
+    }
+    timer->late_hist[bucket] ++;
+}
+#endif
+
+/**
+  * @brief  Get the timer information from the timer ID, of the exported one
+  *         or the one created in the timer pool.
+  * @param  timer_id    The timer ID.
+  * @retval The timer information.
+  */
+static const bos_timer_rom_t *bos_timer_info(uint16_t timer_id)
+{
+#if (BOS_TIMER_POOL_SIZE != 0)
+    if (timer_id >= BOS_MAX_TIMERS)
+    {
+        BOS_ASSERT(timer_id < (BOS_MAX_TIMERS + BOS_TIMER_POOL_SIZE));
+        const bos_timer_rom_t *timer_info =
+            &bos.timer_pool[timer_id - BOS_MAX_TIMERS].info;
+        BOS_ASSERT(timer_info->magic_head == EXPORT_ID_TIMER);
+
+        return timer_info;
+    }
+#endif
+    BOS_ASSERT(timer_id < bos.timer_count);
+
+    return &bos.timer_table[timer_id];
+}
+
+/**
+  * @brief  Record the lateness of the timeout timer, and count the next
+  *         timeout of the periodic one. It is called in the critical section.
+  * @param  timer   The timer data.
+  * @param  info    The timer information.
+  * @param  now     The time of the timer domain.
+  * @retval None.
+  */
+static void bos_timer_reload(bos_timer_t *timer, const bos_timer_rom_t *info,
+                             uint32_t now)
+{
+    /* Count from the time without the slack, not to drift. */
+#if (BOS_USE_TIMER_SLACK != 0)
+    uint32_t expiry = timer->expiry;
+#else
+    uint32_t expiry = timer->timeout;
+#endif
+    uint32_t late = now - expiry;
+#if (BOS_USE_TIMER_STAT != 0)
+    bos_timer_stat_late(timer, late);
+#endif
+
+    if (info->oneshoot == 0)
+    {
+        expiry += timer->period;
+        if (late >= timer->period)
         {
-            task_data = (bos_task_t *)bos.task_table[i].data;
-            if (task_data->state == BosTaskState_Blocked)
+#if (BOS_USE_TIMER_STAT != 0)
+            timer->overrun ++;
+#endif
+            if (timer->catchup == BosTimerCatchup_Skip)
+            {
+                /* The first period end after now, in the same phase. */
+                expiry += (late / timer->period) * timer->period;
+            }
+            else if (timer->catchup == BosTimerCatchup_Realign)
             {
-                if (bos.time >= task_data->timeout)
-                {
-                    task_data->state = BosTaskState_Ready;
-                    task_timeout = true;
-                }
+                expiry = now + timer->period;
             }
         }
-        if (task_idle && task_timeout)
+#if (BOS_USE_TIMER_SLACK != 0)
+        timer->expiry = expiry;
+        timer->timeout = bos_timer_align(expiry, info->slack);
+#else
+        timer->timeout = expiry;
+#endif
+    }
+}
+
+#if (BOS_USE_TIMER_HARD != 0)
+/**
+  * @brief  Run the callbacks of the timeout hard timers, in the tick interrupt.
+  * @retval None.
+  */
+static void bos_timer_hard_run(void)
+{
+    bos_critical_enter();
+
+    /* In tickless mode it runs in the idle loop too, where the tick interrupt
+       may run it nested, so the flag of the outer one is kept. */
+    bool runing = bos.timer_hard_runing;
+    while (bos.timer_hard_list != NULL &&
+           BOS_TIME_REACHED(bos.timer_hard_list->timeout))
+    {
+        bos_timer_t *timer = bos.timer_hard_list;
+        const bos_timer_rom_t *info = bos_timer_info(timer->id);
+
+        bos.timer_hard_list = timer->next;
+        bos_timer_reload(timer, info, bos.time);
+        if (info->oneshoot == 0)
         {
-            bos_critical_exit();
-            bos_sheduler();
-            bos_critical_enter();
+            bos_timer_list_add(&bos.timer_hard_list, timer);
         }
-        
-        if (bos.time >= BOS_MS_NUM_15DAY)
+        else
         {
-            /* Adjust all tasks' timing. */
-            for (uint32_t i = 0; i < bos.task_count; i ++)
-            {
-                task_data = (bos_task_t *)bos.task_table[i].data;
-                if (task_data->state == BosTaskState_Blocked)
-                {
-                    task_data->timeout -= bos.time;
-                }
-            }
+            timer->running = 0;
+        }
 
-            /* Adjust all timers' timing. */
-            for (uint32_t i = 0; i < bos.timer_count; i ++)
-            {
-                timer_data = (bos_timer_t *)bos.timer_table[i].data;
-                if (timer_data->running != 0)
-                {
-                    timer_data->timeout -= bos.time;
-                }
-            }
+        bos.timer_hard_runing = true;
+        bos_critical_exit();
+        info->func(info->parameter);
+        bos_critical_enter();
+        bos.timer_hard_runing = runing;
+    }
 
-            bos.time_out_min -= bos.time;
-            bos.time_offset += bos.time;
-            bos.time = 0;
-        }
+    bos_critical_exit();
+}
+#endif
+
+#if (BOS_USE_TIMER_HARD != 0) || (BOS_TIMER_DOMAINS > 1)
+/**
+  * @brief  Get the timer list of one hard or domain timer.
+  * @param  timer   The timer data.
+  * @param  info    The timer information.
+  * @retval The list, or NULL if the timer is in the timer heap.
+  */
+static bos_timer_t **bos_timer_list_of(bos_timer_t *timer,
+                                       const bos_timer_rom_t *info)
+{
+    (void)timer;
+    (void)info;
+#if (BOS_USE_TIMER_HARD != 0)
+    if (info->hard)
+    {
+        return &bos.timer_hard_list;
+    }
+#endif
+#if (BOS_TIMER_DOMAINS > 1)
+    if (timer->domain != 0)
+    {
+        return &bos.domain_list[timer->domain];
+    }
+#endif
+
+    return NULL;
+}
+
+/**
+  * @brief  Add the timer into the list in the order of timeout, after the ones
+  *         of the same timeout.
+  * @param  list    The timer list.
+  * @param  timer   The timer data.
+  * @retval None.
+  */
+static void bos_timer_list_add(bos_timer_t **list, bos_timer_t *timer)
+{
+    bos_timer_t **link = list;
+
+    while (*link != NULL && !BOS_TIME_BEFORE(timer->timeout, (*link)->timeout))
+    {
+        link = &(*link)->next;
+    }
+    timer->next = *link;
+    *link = timer;
+}
+
+/**
+  * @brief  Remove the timer from the list.
+  * @param  list    The timer list.
+  * @param  timer   The timer data.
+  * @retval None.
+  */
+static void bos_timer_list_remove(bos_timer_t **list, bos_timer_t *timer)
+{
+    bos_timer_t **link = list;
+
+    while (*link != timer)
+    {
+        BOS_ASSERT(*link != NULL);
+        link = &(*link)->next;
+    }
+    *link = timer->next;
+}
+#endif
+
+/**
+  * @brief  Add the timer into the timer heap.
+  * @param  timer   The timer data.
+  * @retval None.
+  */
+static void bos_timer_heap_add(bos_timer_t *timer)
+{
+    BOS_ASSERT(bos.timer_heap_count < (BOS_MAX_TIMERS + BOS_TIMER_POOL_SIZE));
+
+    timer->heap_index = bos.timer_heap_count;
+    bos.timer_heap[bos.timer_heap_count ++] = timer;
+    bos_timer_heap_up(timer->heap_index);
+}
+
+/**
+  * @brief  Remove the timer from the timer heap, the last one fills its place.
+  * @param  timer   The timer data.
+  * @retval None.
+  */
+static void bos_timer_heap_remove(bos_timer_t *timer)
+{
+    uint32_t index = timer->heap_index;
+    bos_timer_t *last = bos.timer_heap[-- bos.timer_heap_count];
 
-        /* if any timer is timeout */
-        if (bos.time >= bos.time_out_min)
+    if (last != timer)
+    {
+        bos.timer_heap[index] = last;
+        last->heap_index = index;
+        bos_timer_heap_up(index);
+        bos_timer_heap_down(last->heap_index);
+    }
+}
+
+/**
+  * @brief  Move the timer toward the top of the heap, while its timeout is
+  *         earlier than its parent's.
+  * @param  index   The heap index of the timer.
+  * @retval None.
+  */
+static void bos_timer_heap_up(uint32_t index)
+{
+    bos_timer_t *timer = bos.timer_heap[index];
+
+    while (index != 0)
+    {
+        uint32_t parent = (index - 1) / 2;
+        if (!BOS_TIME_BEFORE(timer->timeout, bos.timer_heap[parent]->timeout))
         {
-            /* Find the time-out timers and excute the handlers. */
-            for (uint32_t i = 0; i < bos.timer_count; i ++)
-            {
-                timer_data = (bos_timer_t *)bos.timer_table[i].data;
-                if (timer_data->running != 0 && bos.time >= timer_data->timeout)
-                {
-                    bos.timer_cb_runing = true;
-                    bos_critical_exit();
-                    bos.timer_table[i].func(bos.timer_table[i].parameter);
-                    ret = true;
-                    bos_critical_enter();
-                    bos.timer_cb_runing = false;
-                    if (bos.timer_table[i].oneshoot == 0)
-                    {
-                        timer_data->timeout += timer_data->period;
-                    }
-                    else
-                    {
-                        timer_data->running = 0;
-                    }
-                }
-            }
+            break;
+        }
+        bos.timer_heap[index] = bos.timer_heap[parent];
+        bos.timer_heap[index]->heap_index = index;
+        index = parent;
+    }
+    bos.timer_heap[index] = timer;
+    timer->heap_index = index;
+}
 
-            /* Recalculate the minimum timeout value. */
-            if (ret)
-            {
-                uint32_t time_out_min = UINT32_MAX;
-                for (uint32_t i = 0; i < bos.timer_count; i ++)
-                {
-                    timer_data = (bos_timer_t *)bos.timer_table[i].data;
-                    if (timer_data->running != 0 && time_out_min >= timer_data->timeout)
-                    {
-                        time_out_min = timer_data->timeout;
-                    }
-                }
-                bos.time_out_min = time_out_min;
-            }
+/**
+  * @brief  Move the timer toward the bottom of the heap, while any child's
+  *         timeout is earlier than its.
+  * @param  index   The heap index of the timer.
+  * @retval None.
+  */
+static void bos_timer_heap_down(uint32_t index)
+{
+    bos_timer_t *timer = bos.timer_heap[index];
+
+    while (1)
+    {
+        uint32_t child = index * 2 + 1;
+        if (child >= bos.timer_heap_count)
+        {
+            break;
+        }
+        if ((child + 1) < bos.timer_heap_count &&
+            BOS_TIME_BEFORE(bos.timer_heap[child + 1]->timeout,
+                            bos.timer_heap[child]->timeout))
+        {
+            child ++;
+        }
+        if (!BOS_TIME_BEFORE(bos.timer_heap[child]->timeout, timer->timeout))
+        {
+            break;
         }
+        bos.timer_heap[index] = bos.timer_heap[child];
+        bos.timer_heap[index]->heap_index = index;
+        index = child;
+    }
+    bos.timer_heap[index] = timer;
+    timer->heap_index = index;
+}
 
-        bos_critical_exit();
+#if (BOS_USE_TIMER_SLACK != 0)
+/**
+  * @brief  Move the expiry time later within the slack, to the multiple of
+  *         the largest power of two not larger than the slack. Timers with
+  *         close expiries meet at the same time in this way.
+  * @param  time    The expiry time without the slack.
+  * @param  slack   The slack time.
+  * @retval The aligned expiry time.
+  */
+static uint32_t bos_timer_align(uint32_t time, uint32_t slack)
+{
+    if (slack == 0)
+    {
+        return time;
     }
-    
+
+    uint32_t granule = (1U << bos_bit_last(slack));
+    return ((time + granule - 1) & ~(granule - 1));
+}
+#endif
+
+/**
+  * @brief  Wake up all the timeout tasks. Only the head of the sleep list is
+  *         checked, the cost is in the number of the woken tasks.
+  * @retval If false, no task is woken up.
+  */
+static bool bos_task_wakeup(void)
+{
+    bool ret = false;
+    bos_task_t *task_data = NULL;
+
+    while (bos.sleep_list != NULL && BOS_TIME_REACHED(bos.sleep_list->timeout))
+    {
+        task_data = bos.sleep_list;
+        bos.sleep_list = task_data->next;
+        bos_task_set_state(task_data, BosTaskState_Ready);
+        ret = true;
+    }
+
     return ret;
 }
 
+/**
+  * @brief  Insert the blocked task into the sleep list in the order of
+  *         timeout, behind the tasks with the same timeout.
+  * @param  task    The task data.
+  * @retval None.
+  */
+static void bos_sleep_add(bos_task_t *task)
+{
+    bos_task_t **link = &bos.sleep_list;
+
+    while (*link != NULL && !BOS_TIME_BEFORE(task->timeout, (*link)->timeout))
+    {
+        link = &(*link)->next;
+    }
+    task->next = *link;
+    task->prev = NULL;
+    *link = task;
+}
+
 /**
   * @brief  Start BasicOS sheduler.
   * @retval None.
@@ -645,54 +2074,56 @@ static void bos_sheduler(void)
 
     bos_critical_enter();
 
-    /* The actual priority of idle task is 0. */
-    bos_next = &ram_task_timer_data;
-    uint8_t priority = 0;
-    uint32_t count = 0;
-    for (uint32_t i = ((bos_current->task_id + 1) % bos.task_count); ;)
+#if (BOS_USE_EDF != 0)
+    /* No task is ready, run the idle loop in the current context. */
+    while (bos.ready_list == NULL)
     {
-        task_data = (bos_task_t *)bos.task_table[i].data;
-        if (task_data->state == BosTaskState_Ready &&
-            bos.task_table[i].priority > priority)
-        {
-            bos_next = task_data;
-            priority = bos.task_table[i].priority;
-        }
-
-        if (task_data->state == BosTaskState_Ready &&
-            bos.task_table[i].priority == bos.task_table[bos_current->task_id].priority &&
-            bos_next == &ram_task_timer_data)
-        {
-            bos_next = task_data;
-            priority = bos.task_table[i].priority;
-        }
+        bos_critical_exit();
+        bos_idle();
+        bos_critical_enter();
+    }
 
-        count ++;
-        i = (i + 1) % bos.task_count;
-        if (count >= bos.task_count)
-        {
-            break;
-        }
+    /* The head of the ready list has the earliest deadline. */
+    bos_next = bos.ready_list;
+#else
+    /* No task is ready, run the idle loop in the current context. */
+    uint32_t priority = bos_ready_highest();
+    while (priority == 0)
+    {
+        bos_critical_exit();
+        bos_idle();
+        bos_critical_enter();
+        priority = bos_ready_highest();
     }
+
+    /* The head of the highest priority ready ring. */
+#if (BOS_USE_MOVE_COST != 0)
+    bos_next = bos_sheduler_min_move(priority);
+#else
+    bos_next = bos.ready_ring[priority];
+#endif
+#endif
     
     /* Switch the task */
     if (bos_next != bos_current)
     {
-        #define STACK_SIZE_PUSH                 (64)
-        
         uint32_t sp_value = get_sp_value();
         uint32_t _stack_used = (bos.task_count << 7) + (bos.stack_size << 2) -
                                 (sp_value - (uint32_t)bos_current->stack);
         stack_used = (_stack_used > stack_used) ? _stack_used : stack_used;
         
         /* The current task move to front. */
-        if (bos_next->task_id < bos_current->task_id)
+        if (BOS_SLOT(bos_next) < BOS_SLOT(bos_current))
         {
             copy_size = bos_next->stack_size << 2;
             move_size = sp_value - STACK_SIZE_PUSH - (uint32_t)bos_current->stack;
-            for (uint32_t i = bos_next->task_id + 1; i < bos_current->task_id; i ++)
+            for (uint32_t i = BOS_SLOT(bos_next) + 1; i < BOS_SLOT(bos_current); i ++)
             {
-                task_data = (bos_task_t *)bos.task_table[i].data;
+                task_data = BOS_SLOT_TASK(i);
+                /* The free space of every waiting task has been given to the
+                   next one when it was switched out, so its stack is only its
+                   live frame. */
+                BOS_ASSERT(task_data->sp == task_data->stack);
                 task_data->stack = (void *)((uint32_t)task_data->stack + move_size);
                 task_data->sp = (void *)((uint32_t)task_data->sp + move_size);
                 copy_size += task_data->stack_size << 2;
@@ -715,9 +2146,10 @@ static void bos_sheduler(void)
             copy_size = (bos_current->stack_size << 2) - move_size;
             addr_target = (uint32_t)bos_current->stack;
             addr_source = (uint32_t)(sp_value - STACK_SIZE_PUSH);
-            for (uint32_t i = bos_current->task_id + 1; i < bos_next->task_id; i ++)
+            for (uint32_t i = BOS_SLOT(bos_current) + 1; i < BOS_SLOT(bos_next); i ++)
             {
-                task_data = (bos_task_t *)bos.task_table[i].data;
+                task_data = BOS_SLOT_TASK(i);
+                BOS_ASSERT(task_data->sp == task_data->stack);
                 task_data->stack = (void *)((uint32_t)task_data->stack - move_size);
                 task_data->sp = (void *)((uint32_t)task_data->sp - move_size);
                 copy_size += task_data->stack_size << 2;
@@ -730,32 +2162,582 @@ static void bos_sheduler(void)
             move_size = move_size;
         }
 
-        #undef STACK_SIZE_PUSH
-        
+        /* The time slice of the next task starts. */
+        bos.time_switch = bos.time;
+        bos.time_slice = bos.task_table[bos_next->task_id].time_slice;
+
+#if (BOS_USE_STACK_LAYOUT != 0)
+        /* Record the switching statistics. */
+        bos.layout_copy_size += copy_size;
+        bos.layout_switch_count ++;
+        uint32_t id_low = bos_current->task_id;
+        uint32_t id_high = bos_next->task_id;
+        if (id_low > id_high)
+        {
+            id_low = bos_next->task_id;
+            id_high = bos_current->task_id;
+        }
+        if (switch_count[id_low][id_high] < UINT16_MAX)
+        {
+            switch_count[id_low][id_high] ++;
+        }
+#endif
+
         bos_cpu_trig_task_switch();
     }
 
     bos_critical_exit();
 }
 
+#if (BOS_USE_MOVE_COST != 0)
+/**
+  * @brief  Pick the ready task which needs the fewest stack bytes to be moved
+  *         in the given priority ring. One task which has been passed over
+  *         BOS_MOVE_COST_FAIR_LIMIT times is picked first. The current task
+  *         is a candidate only when it is still the head of the ring, so it
+  *         is never picked again after it yields.
+  * @param  priority    The priority of the ready ring.
+  * @retval The next task.
+  */
+static bos_task_t *bos_sheduler_min_move(uint32_t priority)
+{
+    bos_task_t *head = bos.ready_ring[priority];
+    if (head->next == head)
+    {
+        return head;
+    }
+
+    uint32_t sp_value = get_sp_value() - STACK_SIZE_PUSH;
+    bos_task_t *task = head;
+    bos_task_t *task_min = NULL;
+    bos_task_t *task_fair = NULL;
+    uint32_t cost_min = UINT32_MAX;
+    uint32_t cost_head = UINT32_MAX;
+    do
+    {
+        if (task != bos_current)
+        {
+            /*  The moved bytes are the ones between the two tasks' stacks.
+                See bos_sheduler() for the details. */
+            uint32_t cost = (BOS_SLOT(task) < BOS_SLOT(bos_current)) ?
+                            ((uint32_t)bos_current->stack - (uint32_t)task->stack) :
+                            ((uint32_t)task->stack - sp_value);
+            if (cost_head == UINT32_MAX)
+            {
+                cost_head = cost;
+            }
+            if (cost < cost_min)
+            {
+                cost_min = cost;
+                task_min = task;
+            }
+            if (task_fair == NULL &&
+                task->skip_count >= BOS_MOVE_COST_FAIR_LIMIT)
+            {
+                task_fair = task;
+            }
+        }
+        else if (task == head)
+        {
+            /* Not yielded, nothing is moved to keep running it, and the ring
+               order would keep it too. */
+            cost_head = 0;
+            cost_min = 0;
+            task_min = task;
+        }
+        task = task->next;
+    } while (task != head);
+
+    if (task_fair != NULL)
+    {
+        task_min = task_fair;
+    }
+    else
+    {
+        /* The bytes saved against the ring order, which picks the head. */
+        move_saved += (cost_head - cost_min);
+    }
+
+    /* Count the passed-over tasks. */
+    task = head;
+    do
+    {
+        if (task == task_min)
+        {
+            task->skip_count = 0;
+        }
+        else if (task != bos_current && task->skip_count < UINT8_MAX)
+        {
+            task->skip_count ++;
+        }
+        task = task->next;
+    } while (task != head);
+
+    bos.ready_ring[priority] = task_min;
+
+    return task_min;
+}
+#endif
+
 /**
-  * @brief  The idle task entry function.
-  * @param  parameter   The idle task parameter.
+  * @brief  Set the task state, and update the ready set.
+  * @param  task    The task data.
+  * @param  state   The new task state.
   * @retval None.
   */
-static void _entry_idle(void *parameter)
+static void bos_task_set_state(bos_task_t *task, uint8_t state)
 {
-    (void)parameter;
-    
-    while (1)
+    if (state == BosTaskState_Ready && task->state != BosTaskState_Ready)
+    {
+        bos_ready_add(task);
+    }
+    else if (state != BosTaskState_Ready && task->state == BosTaskState_Ready)
+    {
+        bos_ready_remove(task);
+    }
+
+    task->state = state;
+}
+
+#if (BOS_USE_EDF == 0)
+/**
+  * @brief  Add the task to the tail of its priority ring.
+  * @param  task    The task data.
+  * @retval None.
+  */
+static void bos_ready_add(bos_task_t *task)
+{
+    uint32_t priority = bos.priority[task->task_id];
+    bos_task_t *head = bos.ready_ring[priority];
+
+    if (head == NULL)
+    {
+        task->next = task;
+        task->prev = task;
+        bos.ready_ring[priority] = task;
+#if (BOS_MAX_PRIORITY > 31)
+        bos.ready_priority[priority / 32] |= (1U << (priority % 32));
+        bos.ready_group |= (1U << (priority / 32));
+#else
+        bos.ready_priority |= (1U << priority);
+#endif
+    }
+    else
+    {
+        task->next = head;
+        task->prev = head->prev;
+        head->prev->next = task;
+        head->prev = task;
+    }
+}
+
+/**
+  * @brief  Remove the task from its priority ring.
+  * @param  task    The task data.
+  * @retval None.
+  */
+static void bos_ready_remove(bos_task_t *task)
+{
+    uint32_t priority = bos.priority[task->task_id];
+
+    if (task->next == task)
+    {
+        bos.ready_ring[priority] = NULL;
+#if (BOS_MAX_PRIORITY > 31)
+        bos.ready_priority[priority / 32] &= ~(1U << (priority % 32));
+        if (bos.ready_priority[priority / 32] == 0)
+        {
+            bos.ready_group &= ~(1U << (priority / 32));
+        }
+#else
+        bos.ready_priority &= ~(1U << priority);
+#endif
+    }
+    else
+    {
+        task->prev->next = task->next;
+        task->next->prev = task->prev;
+        if (bos.ready_ring[priority] == task)
+        {
+            bos.ready_ring[priority] = task->next;
+        }
+    }
+}
+
+/**
+  * @brief  Get the highest priority which has ready tasks.
+  * @retval The priority, 0 when no task is ready.
+  */
+static uint32_t bos_ready_highest(void)
+{
+#if (BOS_MAX_PRIORITY > 31)
+    if (bos.ready_group == 0)
+    {
+        return 0;
+    }
+
+    uint32_t group = bos_bit_last(bos.ready_group);
+    return (group * 32 + bos_bit_last(bos.ready_priority[group]));
+#else
+    if (bos.ready_priority == 0)
+    {
+        return 0;
+    }
+
+    return bos_bit_last(bos.ready_priority);
+#endif
+}
+
+/**
+  * @brief  Add the task into its priority ring, to run just after the current
+  *         task yields.
+  * @param  task    The task data.
+  * @retval None.
+  */
+static void bos_ready_add_next(bos_task_t *task)
+{
+    uint32_t priority = bos.priority[task->task_id];
+
+    if (bos_current->state == BosTaskState_Ready &&
+        bos.priority[bos_current->task_id] == priority)
+    {
+        /* Link it behind the current task, which is the ring head. */
+        task->prev = bos_current;
+        task->next = bos_current->next;
+        bos_current->next->prev = task;
+        bos_current->next = task;
+    }
+    else
+    {
+        bos_ready_add(task);
+        bos.ready_ring[priority] = task;
+    }
+}
+#else
+/**
+  * @brief  Insert the task into the ready list in deadline order, behind the
+  *         tasks with the same deadline.
+  * @param  task    The task data.
+  * @retval None.
+  */
+static void bos_ready_add(bos_task_t *task)
+{
+    bos_task_t *prev = NULL;
+    bos_task_t *next = bos.ready_list;
+
+    while (next != NULL && (int32_t)(next->deadline - task->deadline) <= 0)
+    {
+        prev = next;
+        next = next->next;
+    }
+
+    task->prev = prev;
+    task->next = next;
+    if (next != NULL)
+    {
+        next->prev = task;
+    }
+    if (prev != NULL)
+    {
+        prev->next = task;
+    }
+    else
+    {
+        bos.ready_list = task;
+    }
+}
+
+/**
+  * @brief  Remove the task from the ready list.
+  * @param  task    The task data.
+  * @retval None.
+  */
+static void bos_ready_remove(bos_task_t *task)
+{
+    if (task->next != NULL)
+    {
+        task->next->prev = task->prev;
+    }
+    if (task->prev != NULL)
+    {
+        task->prev->next = task->next;
+    }
+    else
+    {
+        bos.ready_list = task->next;
+    }
+}
+
+/**
+  * @brief  Insert the task into the ready list in deadline order, in front of
+  *         the tasks with the same deadline.
+  * @param  task    The task data.
+  * @retval None.
+  */
+static void bos_ready_add_next(bos_task_t *task)
+{
+    bos_task_t *prev = NULL;
+    bos_task_t *next = bos.ready_list;
+
+    while (next != NULL && (int32_t)(next->deadline - task->deadline) < 0)
+    {
+        prev = next;
+        next = next->next;
+    }
+
+    task->prev = prev;
+    task->next = next;
+    if (next != NULL)
+    {
+        next->prev = task;
+    }
+    if (prev != NULL)
+    {
+        prev->next = task;
+    }
+    else
+    {
+        bos.ready_list = task;
+    }
+}
+#endif
+
+#if (BOS_USE_EDF == 0) || (BOS_USE_TIMER_STAT != 0) || (BOS_USE_TIMER_SLACK != 0)
+/**
+  * @brief  Get the index of the highest set bit.
+  * @param  value   The value which is NOT zero.
+  * @retval The bit index.
+  */
+static uint32_t bos_bit_last(uint32_t value)
+{
+#if defined(BOS_CLZ)
+    return (31 - BOS_CLZ(value));
+#else
+    /* ARMv6-M has no CLZ instruction, use a nibble lookup table. */
+    static const uint8_t table[16] =
+    {
+        0, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3,
+    };
+    uint32_t index = 0;
+
+    if ((value & 0xffff0000U) != 0)
+    {
+        value >>= 16;
+        index += 16;
+    }
+    if ((value & 0xff00U) != 0)
+    {
+        value >>= 8;
+        index += 8;
+    }
+    if ((value & 0xf0U) != 0)
+    {
+        value >>= 4;
+        index += 4;
+    }
+
+    return (index + table[value]);
+#endif
+}
+#endif
+
+/**
+  * @brief  The idle function. It runs in the context of the task which calls
+  *         bos_sheduler() when no task is ready, so no task stack is moved to
+  *         get into the idle state.
+  * @retval None.
+  */
+static void bos_idle(void)
+{
+    bos.idle_running = true;
+
+    /* If no task is woken up and no timer is timeout. */
+    if (!bos_check_timer())
+    {
+#if (BOS_USE_STACK_LAYOUT != 0)
+        bos_stack_layout();
+#endif
+        bos_hook_idle();
+#if (BOS_USE_TICKLESS != 0)
+        bos_idle_sleep();
+#endif
+    }
+
+    bos.idle_running = false;
+}
+
+#if (BOS_USE_TICKLESS != 0)
+/**
+  * @brief  Sleep until the next task timeout or timer expiry, and then add
+  *         the passed ticks to the kernel time in one step.
+  * @retval None.
+  */
+static void bos_idle_sleep(void)
+{
+    bos_critical_enter();
+
+#if (BOS_USE_EDF != 0)
+    bool ready = (bos.ready_list != NULL);
+#else
+    bool ready = (bos_ready_highest() != 0);
+#endif
+    /* Get the time to the nearest timeout, 0 if it is reached already. */
+    int32_t time_sleep = (int32_t)BOS_MS_NUM_MAX;
+    if (bos.sleep_list != NULL &&
+        (int32_t)(bos.sleep_list->timeout - bos.time) < time_sleep)
+    {
+        time_sleep = (int32_t)(bos.sleep_list->timeout - bos.time);
+    }
+    if (bos.timer_heap_count != 0 &&
+        (int32_t)(bos.timer_heap[0]->timeout - bos.time) < time_sleep)
+    {
+        time_sleep = (int32_t)(bos.timer_heap[0]->timeout - bos.time);
+    }
+#if (BOS_USE_TIMER_HARD != 0)
+    if (bos.timer_hard_list != NULL &&
+        (int32_t)(bos.timer_hard_list->timeout - bos.time) < time_sleep)
+    {
+        time_sleep = (int32_t)(bos.timer_hard_list->timeout - bos.time);
+    }
+#endif
+
+    /* Not when a task gets ready or the timeout is reached meanwhile. */
+    if (!ready && time_sleep > 0)
+    {
+        uint32_t ticks = (time_sleep + BOS_TICK_MS - 1) / BOS_TICK_MS;
+        uint32_t time_passed = bos_cpu_sleep(ticks) * BOS_TICK_MS;
+        bos.time += time_passed;
+        if (bos.time < time_passed)
+        {
+            bos.time_high ++;
+        }
+    }
+
+    bos_critical_exit();
+
+#if (BOS_USE_TIMER_HARD != 0)
+    /* The slept ticks are not counted by bos_tick(), run the hard timers at
+       the waking up. */
+    bos_timer_hard_run();
+#endif
+}
+#endif
+
+#if (BOS_USE_STACK_LAYOUT != 0)
+/**
+  * @brief  Get the switching count between two tasks.
+  * @param  task_a  One task.
+  * @param  task_b  The other task.
+  * @retval The switching count.
+  */
+static uint32_t bos_switch_count(bos_task_t *task_a, bos_task_t *task_b)
+{
+    if (task_a->task_id < task_b->task_id)
+    {
+        return switch_count[task_a->task_id][task_b->task_id];
+    }
+    else
+    {
+        return switch_count[task_b->task_id][task_a->task_id];
+    }
+}
+
+/**
+  * @brief  Reverse the words in the memory.
+  * @param  start   The first word.
+  * @param  end     The word behind the last one.
+  * @retval None.
+  */
+static void bos_stack_reverse(uint32_t *start, uint32_t *end)
+{
+    while (start < (-- end))
+    {
+        uint32_t temp = *start;
+        *start = *end;
+        *end = temp;
+        start ++;
+    }
+}
+
+/**
+  * @brief  Adjust the tasks' order in the shared stack. Two neighbour tasks
+  *         are swapped when it makes the weighted distance of all switching
+  *         pairs shorter. The running task is never moved.
+  * @retval None.
+  */
+static void bos_stack_layout(void)
+{
+    if ((bos.time - bos.layout_time) < BOS_STACK_LAYOUT_PERIOD)
+    {
+        return;
+    }
+    bos.layout_time = bos.time;
+
+    bos_critical_enter();
+    if (bos.layout_switch_count != 0)
+    {
+        bos.layout_info.copy_before = bos.layout_copy_size / bos.layout_switch_count;
+    }
+    bos.layout_info.count ++;
+    bos.layout_copy_size = 0;
+    bos.layout_switch_count = 0;
+    bos_critical_exit();
+
+    for (uint32_t slot = 0; slot + 1 < bos.task_count; slot ++)
     {
-        /* If no timer is timeout. */
-        if (!bos_check_timer(true))
+        bos_task_t *task_a = bos.slot_task[slot];
+        bos_task_t *task_b = bos.slot_task[slot + 1];
+        if (task_a == bos_current || task_b == bos_current)
         {
-            bos_hook_idle();
+            continue;
+        }
+
+        /*  After swapping, task b lies between task a and the tasks in front
+            of them, and task a lies between task b and the tasks behind. */
+        int64_t delta = 0;
+        for (uint32_t i = 0; i < bos.task_count; i ++)
+        {
+            if (i == slot || i == (slot + 1))
+            {
+                continue;
+            }
+            bos_task_t *task = bos.slot_task[i];
+            int64_t size_a = (int64_t)bos_switch_count(task, task_b) * task_a->stack_size;
+            int64_t size_b = (int64_t)bos_switch_count(task, task_a) * task_b->stack_size;
+            delta += (i < slot) ? (size_b - size_a) : (size_a - size_b);
+        }
+        if (delta >= 0)
+        {
+            continue;
+        }
+
+        /* Swap the two stacks by rotating the memory in place. */
+        uint32_t *start = (uint32_t *)task_a->stack;
+        uint32_t *end = start + task_a->stack_size + task_b->stack_size;
+        bos_stack_reverse(start, start + task_a->stack_size);
+        bos_stack_reverse(start + task_a->stack_size, end);
+        bos_stack_reverse(start, end);
+
+        task_b->stack = start;
+        task_b->sp = start;
+        task_a->stack = start + task_b->stack_size;
+        task_a->sp = task_a->stack;
+        task_a->slot = slot + 1;
+        task_b->slot = slot;
+        bos.slot_task[slot] = task_b;
+        bos.slot_task[slot + 1] = task_a;
+    }
+
+    /* Age the switching counts. */
+    for (uint32_t i = 0; i < bos.task_count; i ++)
+    {
+        for (uint32_t j = i + 1; j < bos.task_count; j ++)
+        {
+            switch_count[i][j] >>= 1;
         }
     }
 }
+#endif
 
 /**
   * @brief  Callback function if the timer.
@@ -45,20 +45,39 @@ extern "C" {
 
 /* Public config ------------------------------------------------------------ */
 /**
-  * @brief  The maximum number of tasks in BasicOS.
+  * @brief  The maximum number of tasks in BasicOS, 256 at most.
   */
 #define BOS_MAX_TASKS                           (16)
 
 /**
-  * @brief  The maximum priority of tasks in BasicOS.
+  * @brief  The maximum priority of tasks in BasicOS, 255 at most. When it is
+  *         larger than 31, a two-level ready bitmap is used.
   */
 #define BOS_MAX_PRIORITY                        (8)
 
+/**
+  * @brief  The maximum number of soft timers in BasicOS, 1023 at most.
+  */
+#define BOS_MAX_TIMERS                          (16)
+
+/**
+  * @brief  The number of soft timers which can be created in runtime by
+  *         bos_timer_create(), 0 means none. Together with BOS_MAX_TIMERS,
+  *         1023 at most.
+  */
+#define BOS_TIMER_POOL_SIZE                     (0)
+
 /**
   * @brief  The tick period time in mili-second.
   */
 #define BOS_TICK_MS                             (1)
 
+/**
+  * @brief  The default time slice of tasks in mili-second, used by
+  *         bos_should_yield(). 0 means no time slice.
+  */
+#define BOS_TIME_SLICE_DEFAULT                  (10)
+
 /**
   * @brief  Basic assert function configuration.
   */
@@ -74,15 +93,142 @@ extern "C" {
   */
 #define BOS_USE_CPU_USAGE                       (0)
 
+/**
+  * @brief  Among the ready tasks with the same priority, pick the one which
+  *         needs the fewest stack bytes to be moved.
+  */
+#define BOS_USE_MOVE_COST                       (0)
+
+/**
+  * @brief  How many times one ready task can be passed over by the move-cost
+  *         policy before it must be picked.
+  */
+#define BOS_MOVE_COST_FAIR_LIMIT                (4)
+
+/**
+  * @brief  Reorder the tasks' stacks in the shared stack in the idle time, to
+  *         put the tasks switching to each other often side by side.
+  */
+#define BOS_USE_STACK_LAYOUT                    (0)
+
+/**
+  * @brief  The period of the stack layout adjustment in mili-second.
+  */
+#define BOS_STACK_LAYOUT_PERIOD                 (1000)
+
+/**
+  * @brief  Earliest-deadline-first scheduling. The task priorities are not
+  *         used, and the ready task with the earliest deadline runs first.
+  * @note   The ready list is kept in deadline order, so making one task ready
+  *         costs O(n) in the number of ready tasks.
+  * @note   The deadline is set again only in bos_delay_ms(),
+  *         bos_task_wait_period() and bos_task_set_deadline(), not in
+  *         bos_task_yield(). A task which never calls them keeps its first
+  *         deadline, BOS_EDF_DEADLINE_DEFAULT after the start, and runs
+  *         before all the tasks with later deadlines. If it never blocks
+  *         either, they are starved.
+  */
+#define BOS_USE_EDF                             (0)
+
+/**
+  * @brief  The default relative deadline of tasks in mili-second.
+  */
+#define BOS_EDF_DEADLINE_DEFAULT                (1000)
+
+/**
+  * @brief  Tickless idle. When no task is ready, the idle loop sleeps through
+  *         bos_cpu_sleep() until the next task timeout or timer expiry,
+  *         instead of being woken up by every tick.
+  */
+#define BOS_USE_TICKLESS                        (0)
+
+/**
+  * @brief  Timer slack. A timer exported with some slack may expire later
+  *         within it, so the near expiries share one wakeup.
+  */
+#define BOS_USE_TIMER_SLACK                     (0)
+
+/**
+  * @brief  Micro-second clock, bos_time_us() and bos_delay_us() through the
+  *         port function bos_cpu_time_us().
+  */
+#define BOS_USE_TIME_US                         (0)
+
+/**
+  * @brief  Run the timer callbacks in the timer service task, instead of in
+  *         the task which yields or in the idle loop.
+  */
+#define BOS_USE_TIMER_SERVICE                   (0)
+
+/**
+  * @brief  The priority of the timer service task.
+  */
+#define BOS_TIMER_SERVICE_PRIORITY              (BOS_MAX_PRIORITY)
+
+/**
+  * @brief  Periodic tasks exported by bos_task_export_periodic, released by
+  *         the kernel at the multiples of their period.
+  */
+#define BOS_USE_TASK_PERIODIC                   (0)
+
+/**
+  * @brief  Hard timers exported by bos_timer_export_hard. Their callbacks run
+  *         in bos_tick(), in the tick interrupt, and may only start or stop
+  *         timers.
+  */
+#define BOS_USE_TIMER_HARD                      (0)
+
+/**
+  * @brief  The number of time domains of soft timers, 256 at most. Domain 0 is
+  *         the kernel time ticked by bos_tick(), and every other domain has
+  *         its own time ticked by bos_tick_domain(), for example by one
+  *         low-power timer still running in the stop mode.
+  */
+#define BOS_TIMER_DOMAINS                       (1)
+
+/**
+  * @brief  Keep the lateness and overrun statistics of every soft timer.
+  */
+#define BOS_USE_TIMER_STAT                      (0)
+
+/**
+  * @brief  The bucket number of the timer lateness histogram. Bucket 0 counts
+  *         the callbacks on time, bucket n the ones late by 2^(n-1) to 2^n - 1
+  *         mili-seconds, and the last one all the later ones.
+  */
+#define BOS_TIMER_LATE_BUCKETS                  (8)
+
+/**
+  * @brief  Find the task and timer IDs by name in hash tables, instead of
+  *         comparing all names one by one.
+  */
+#define BOS_USE_NAME_HASH                       (0)
+
+/**
+  * @brief  The entry number of each name hash table, a power of two and
+  *         larger than BOS_MAX_TASKS and BOS_MAX_TIMERS. Twice of them keeps
+  *         the lookup short.
+  */
+#define BOS_NAME_HASH_SIZE                      (64)
+
 /* Data structure ----------------------------------------------------------- */
 enum bos_error
 {
     BOS_OK                          = 0,
     BOS_NOT_FOUND                   = -1,
+    BOS_NO_MEMORY                   = -2,
 };
 
 typedef void (* bos_func_t)(void *parameter);
 
+/* What a periodic timer does after it has missed whole periods. */
+enum bos_timer_catchup
+{
+    BosTimerCatchup_All = 0,                /* Run the missed ones in a row */
+    BosTimerCatchup_Skip,                   /* Skip them, keep the phase */
+    BosTimerCatchup_Realign,                /* Count the period from now */
+};
+
 typedef struct bos_task_rom
 {
     uint32_t magic_head;
@@ -91,6 +237,11 @@ typedef struct bos_task_rom
     const char *name;
     void *parameter;
     void *data;
+    uint32_t time_slice;
+#if (BOS_USE_TASK_PERIODIC != 0)
+    uint32_t period;                        /* 0 when it is not periodic */
+    uint32_t phase;
+#endif
     uint32_t magic_tail;
 } bos_task_rom_t;
 
@@ -102,6 +253,15 @@ typedef struct bos_timer_rom
     void *parameter;
     void *data;
     bool oneshoot;
+#if (BOS_USE_TIMER_HARD != 0)
+    bool hard;
+#endif
+#if (BOS_TIMER_DOMAINS > 1)
+    uint8_t domain;
+#endif
+#if (BOS_USE_TIMER_SLACK != 0)
+    uint32_t slack;
+#endif
     uint32_t magic_tail;
 } bos_timer_rom_t;
 
@@ -110,7 +270,28 @@ typedef struct eos_task
 {
     void *sp;
     void *stack;
+    /* Links in the ready ring, or in the sleep list when blocked. */
+    struct eos_task *next;
+    struct eos_task *prev;
     uint32_t timeout;
+#if (BOS_USE_MOVE_COST != 0)
+    uint8_t skip_count;
+#endif
+#if (BOS_USE_STACK_LAYOUT != 0)
+    uint8_t slot;
+#endif
+#if (BOS_USE_EDF != 0)
+    uint32_t deadline;
+    uint16_t deadline_relative;
+    uint16_t deadline_miss;
+#endif
+#if (BOS_USE_TASK_PERIODIC != 0)
+    uint32_t release;                       /* The time of the last release */
+    uint16_t jitter_last;
+    uint16_t jitter_max;
+    uint32_t release_count;
+    uint32_t release_miss;
+#endif
     uint32_t stack_size             : 16;
     uint32_t state                  : 4;
     uint32_t state_bkp              : 4;
@@ -120,13 +301,65 @@ typedef struct eos_task
 /* Timer related. */
 typedef struct eos_timer
 {
+#if (BOS_USE_TIMER_HARD != 0) || (BOS_TIMER_DOMAINS > 1)
+    struct eos_timer *next;                 /* Link in the timer list */
+#endif
     uint32_t timeout;
     uint32_t period;
+#if (BOS_USE_TIMER_SLACK != 0)
+    uint32_t expiry;                        /* The time without the slack */
+#endif
+#if (BOS_USE_TIMER_SERVICE != 0)
+    uint32_t exec_last;
+    uint32_t exec_max;
+#endif
+#if (BOS_USE_TIMER_STAT != 0)
+    uint32_t late_min;
+    uint32_t late_max;
+    uint32_t overrun;
+    uint32_t late_hist[BOS_TIMER_LATE_BUCKETS];
+#endif
     uint32_t id                     : 10;
     uint32_t domain                 : 8;
     uint32_t running                : 1;
+    uint32_t heap_index             : 10;
+    uint32_t catchup                : 2;
 } bos_timer_t;
 
+/* Timer statistics. The callback time is in micro-second with
+   BOS_USE_TIME_US or else in mili-second, and the lateness in mili-second. */
+typedef struct bos_timer_stat
+{
+#if (BOS_USE_TIMER_SERVICE != 0)
+    uint32_t exec_last;                     /* Callback time of the last run */
+    uint32_t exec_max;                      /* The longest callback time */
+#endif
+#if (BOS_USE_TIMER_STAT != 0)
+    uint32_t late_min;                      /* The least lateness */
+    uint32_t late_max;                      /* The most lateness */
+    uint32_t overrun;                       /* Runs late by whole periods */
+    uint32_t late_hist[BOS_TIMER_LATE_BUCKETS];
+#endif
+} bos_timer_stat_t;
+
+/* Periodic task statistics, the jitter is in mili-second. */
+typedef struct bos_task_period_stat
+{
+    uint32_t release_count;                 /* The release number */
+    uint32_t release_miss;                  /* Jobs not done before the next
+                                               release */
+    uint16_t jitter_last;                   /* Delay of the last release */
+    uint16_t jitter_max;                    /* The longest release delay */
+} bos_task_period_stat_t;
+
+/* Stack layout information. */
+typedef struct bos_layout_info
+{
+    uint32_t count;                         /* Times of layout adjustment */
+    uint32_t copy_before;                   /* Bytes per switch before it */
+    uint32_t copy_after;                    /* Bytes per switch after it */
+} bos_layout_info_t;
+
 /* Task --------------------------------------------------------------------- */
 /**
   * @brief  BasicOS stack and tasks initialization.
@@ -148,6 +381,12 @@ void basic_os_run(void);
   */
 uint32_t bos_time(void);
 
+/**
+  * @brief  Get the 64-bit BasicOS time in mili-second, which never wraps.
+  * @retval BasicOS time in mili-second
+  */
+uint64_t bos_time64(void);
+
 /**
   * @brief  The BasicOS tick function. Please put it into one timer ISR and set
   *         the BOS_TICK_MS macro to the correct value.
@@ -155,6 +394,23 @@ uint32_t bos_time(void);
   */
 void bos_tick(void);
 
+#if (BOS_TIMER_DOMAINS > 1)
+/**
+  * @brief  The tick function of one time domain. Please put it into the timer
+  *         ISR of the domain.
+  * @param  domain      The time domain, 1 at least.
+  * @retval None.
+  */
+void bos_tick_domain(uint8_t domain);
+
+/**
+  * @brief  Get the time of one time domain, in its ticks.
+  * @param  domain      The time domain, 1 at least.
+  * @retval The domain time.
+  */
+uint32_t bos_time_domain(uint8_t domain);
+#endif
+
 /**
   * @brief  The BasicOS delay function in the current thread.
   * @param  time_ms     Delayed time in mili-seconds.
@@ -163,8 +419,27 @@ void bos_tick(void);
   */
 void bos_delay_ms(uint32_t time_ms);
 
+#if (BOS_USE_TIME_US != 0)
+/**
+  * @brief  Get the BasicOS time in micro-second.
+  * @note   The value wraps around every 71.6 minutes.
+  * @retval BasicOS time in micro-second
+  */
+uint32_t bos_time_us(void);
+
+/**
+  * @brief  The BasicOS delay function in micro-second in the current thread.
+  *         The whole ticks are slept, only the rest is busy-waited.
+  * @param  time_us     Delayed time in micro-seconds.
+  * @note   It can NOT be used in the Idle hook function.
+  * @retval None.
+  */
+void bos_delay_us(uint32_t time_us);
+#endif
+
 /**
   * @brief  The BasicOS terminate the current thread.
+  * @note   It can NOT be used in the Idle hook or timer callbacks.
   * @retval None.
   */
 void bos_task_exit(void);
@@ -174,16 +449,100 @@ void bos_task_exit(void);
   *         However, if there are no other tasks at a higher or equal priority 
   *         to the task that calls bos_task_yield() then the RTOS scheduler will
   *         simply select the task that called bos_task_yield() to run again.
+  * @note   It can NOT be used in the Idle hook or timer callbacks.
   * @retval None.
   */
 void bos_task_yield(void);
 
+/**
+  * @brief  Check if the current task should yield now, when a higher priority
+  *         task is ready, or the current task has run out of its time slice
+  *         and another task is waiting. It is cheap to call in long loops.
+  * @note   It can NOT be used in the Idle hook or timer callbacks.
+  * @retval True if the current task should call bos_task_yield().
+  */
+bool bos_should_yield(void);
+
+/**
+  * @brief  Switch to the given ready task directly, and the current task goes
+  *         back to the ready set. The priority rules still apply, so a higher
+  *         priority task runs before the given one. If the given task is not
+  *         ready, it works the same as bos_task_yield().
+  * @param  task_id     The task ID.
+  * @note   It can NOT be used in the Idle hook or timer callbacks.
+  * @retval None.
+  */
+void bos_task_yield_to(uint16_t task_id);
+
+/**
+  * @brief  Get the BasicOS task's ID from its name.
+  * @retval Task ID when positive or error id when negetive.
+  */
+int16_t bos_task_get_id(const char *name);
+
+#if (BOS_USE_TASK_PERIODIC != 0)
+/**
+  * @brief  Wait for the next release of the current periodic task, exported by
+  *         bos_task_export_periodic. Call it at the top of the task loop. If
+  *         the release has passed, the missed ones are skipped and it returns
+  *         at once.
+  * @retval None.
+  */
+void bos_task_wait_period(void);
+
+/**
+  * @brief  Get the release statistics of one periodic task.
+  * @param  task_id     The task ID.
+  * @param  stat        The periodic task statistics.
+  * @retval None.
+  */
+void bos_task_get_period_stat(uint16_t task_id, bos_task_period_stat_t *stat);
+#endif
+
+#if (BOS_USE_EDF != 0)
+/**
+  * @brief  Set the relative deadline of the current task. The current job has
+  *         to be done in it from now, and every job later has to be done in it
+  *         from its waking up in bos_delay_ms.
+  * @param  deadline_ms The relative deadline in mili-second.
+  * @note   It can NOT be used in the Idle hook or timer callbacks.
+  * @retval None.
+  */
+void bos_task_set_deadline(uint32_t deadline_ms);
+
+/**
+  * @brief  Get the deadline missing count of the task.
+  * @param  task_id     The task ID.
+  * @retval The deadline missing count.
+  */
+uint32_t bos_task_get_deadline_miss(uint16_t task_id);
+#endif
+
 /**
   * @brief  Estimate the used stack size in the BasicOS kernel.
   * @retval The used stack size.
   */
 uint32_t bos_get_used_stack_size(void);
 
+#if (BOS_USE_MOVE_COST != 0)
+/**
+  * @brief  Get the stack bytes not moved thanks to the move-cost policy,
+  *         compared with the plain round-robin order.
+  * @retval The saved bytes.
+  */
+uint32_t bos_get_move_saved_size(void);
+#endif
+
+#if (BOS_USE_STACK_LAYOUT != 0)
+/**
+  * @brief  Get the copied stack bytes per switch, before and after the last
+  *         stack layout adjustment.
+  * @param  info    The layout information.
+  * @retval None.
+  */
+void bos_get_layout_info(bos_layout_info_t *info);
+#endif
+
 /* Soft timer --------------------------------------------------------------- */
 /**
   * @brief  Get the BasicOS timer's ID from its name.
@@ -207,14 +566,94 @@ void bos_timer_start(uint16_t timer_id, uint32_t period);
 void bos_timer_stop(uint16_t timer_id);
 
 /**
-  * @brief  Re-start one soft timer exported by bos_timer_export.
+  * @brief  Re-start one soft timer exported by bos_timer_export, its timeout
+  *         is counted from now again.
   * @param  timer_id    The timer ID.
   * @param  period      The soft-timer's period in mili-second.
   * @retval None.
   */
 void bos_timer_reset(uint16_t timer_id, uint32_t period);
 
+#if (BOS_TIMER_POOL_SIZE != 0)
+/**
+  * @brief  Create one soft timer from the timer pool. It is used as the timer
+  *         exported by bos_timer_export, by the returned ID.
+  * @param  func        The timer callback function.
+  * @param  oneshoot    One-shoot timer or periodic timer.
+  * @param  para        The timer paramter.
+  * @retval Timer ID when positive or BOS_NO_MEMORY when the pool is empty.
+  */
+int16_t bos_timer_create(bos_func_t func, bool oneshoot, void *para);
+
+/**
+  * @brief  Stop the soft timer created by bos_timer_create, and put it back
+  *         into the timer pool.
+  * @param  timer_id    The timer ID.
+  * @retval None.
+  */
+void bos_timer_delete(uint16_t timer_id);
+#endif
+
+/**
+  * @brief  Set what the periodic timer does after it has missed whole periods,
+  *         BosTimerCatchup_All by default.
+  * @param  timer_id    The timer ID.
+  * @param  catchup     The catch-up policy in enum bos_timer_catchup.
+  * @retval None.
+  */
+void bos_timer_set_catchup(uint16_t timer_id, uint8_t catchup);
+
+#if (BOS_USE_TIMER_SERVICE != 0) || (BOS_USE_TIMER_STAT != 0)
+/**
+  * @brief  Get the statistics of one soft timer.
+  * @param  timer_id    The timer ID.
+  * @param  stat        The timer statistics.
+  * @retval None.
+  */
+void bos_timer_get_stat(uint16_t timer_id, bos_timer_stat_t *stat);
+
+/**
+  * @brief  Clear the statistics of one soft timer.
+  * @param  timer_id    The timer ID.
+  * @retval None.
+  */
+void bos_timer_clear_stat(uint16_t timer_id);
+#endif
+
+#if (BOS_USE_TIMER_SLACK != 0)
+/**
+  * @brief  Get the wakeups saved by the timer slack, counted as the timers
+  *         whose expiry is moved by the slack to the wakeup of other timers.
+  *         When only the moved timers expire in one wakeup, one of them is
+  *         not counted.
+  * @retval The saved wakeups.
+  */
+uint32_t bos_get_wakeup_saved(void);
+#endif
+
 /* Export ------------------------------------------------------------------- */
+/**
+  * @brief  Get the ID of one exported task or timer by its name, without any
+  *         name lookup. They are valid after basic_os_init().
+  * @param  _name       The task or timer name.
+  * @retval The task or timer ID.
+  */
+#define BOS_TASK_ID(_name)                                                     \
+    ((uint16_t)((bos_task_t *)rom_task_##_name.data)->task_id)
+#define BOS_TIMER_ID(_name)                                                    \
+    ((uint16_t)((bos_timer_t *)tim_##_name.data)->id)
+
+/**
+  * @brief  Declare one task or timer exported in another source file, to use
+  *         BOS_TASK_ID or BOS_TIMER_ID with it.
+  * @param  _name       The task or timer name.
+  * @retval None.
+  */
+#define bos_task_extern(_name)                                                 \
+    extern const bos_task_rom_t rom_task_##_name
+#define bos_timer_extern(_name)                                                \
+    extern const bos_timer_rom_t tim_##_name
+
 /**
   * @brief  Export one BasicOS task.
   * @param  _name       The task name.
@@ -224,6 +663,18 @@ void bos_timer_reset(uint16_t timer_id, uint32_t period);
   * @retval None.
   */
 #define bos_task_export(_name, _func, _priority, para)                         \
+    bos_task_export_slice(_name, _func, _priority, para, BOS_TIME_SLICE_DEFAULT)
+
+/**
+  * @brief  Export one BasicOS task with its time slice.
+  * @param  _name       The task name.
+  * @param  _func       The task entry function.
+  * @param  _priority   The task priority.
+  * @param  para        The task paramter.
+  * @param  _slice      The time slice in mili-second, 0 means no time slice.
+  * @retval None.
+  */
+#define bos_task_export_slice(_name, _func, _priority, para, _slice)           \
     static bos_task_t ram_##_name##_data;                                      \
     BOS_USED const bos_task_rom_t rom_task_##_name BOS_SECTION("task_rom") =   \
     {                                                                          \
@@ -232,10 +683,41 @@ void bos_timer_reset(uint16_t timer_id, uint32_t period);
         .priority = (uint32_t)_priority,                                       \
         .parameter = para,                                                     \
         .data = &ram_##_name##_data,                                           \
+        .time_slice = (uint32_t)_slice,                                        \
         .magic_head = EXPORT_ID_TASK,                                          \
         .magic_tail = EXPORT_ID_TASK,                                          \
     }
 
+#if (BOS_USE_TASK_PERIODIC != 0)
+/**
+  * @brief  Export one BasicOS periodic task. Its loop waits for every release
+  *         in bos_task_wait_period(), at the phase plus the multiples of the
+  *         period from the start of BasicOS.
+  * @param  _name       The task name.
+  * @param  _func       The task entry function.
+  * @param  _priority   The task priority.
+  * @param  para        The task paramter.
+  * @param  _period     The release period in mili-second.
+  * @param  _phase      The first release time in mili-second.
+  * @retval None.
+  */
+#define bos_task_export_periodic(_name, _func, _priority, para, _period, _phase)\
+    static bos_task_t ram_##_name##_data;                                      \
+    BOS_USED const bos_task_rom_t rom_task_##_name BOS_SECTION("task_rom") =   \
+    {                                                                          \
+        .name = #_name,                                                        \
+        .func = _func,                                                         \
+        .priority = (uint32_t)_priority,                                       \
+        .parameter = para,                                                     \
+        .data = &ram_##_name##_data,                                           \
+        .time_slice = (uint32_t)BOS_TIME_SLICE_DEFAULT,                        \
+        .period = (uint32_t)_period,                                           \
+        .phase = (uint32_t)_phase,                                             \
+        .magic_head = EXPORT_ID_TASK,                                          \
+        .magic_tail = EXPORT_ID_TASK,                                          \
+    }
+#endif
+
 /**
   * @brief  Export one BasicOS timer.
   * @param  _name       The timer name.
@@ -257,6 +739,82 @@ void bos_timer_reset(uint16_t timer_id, uint32_t period);
         .magic_tail = EXPORT_ID_TIMER,                                         \
     }
 
+#if (BOS_USE_TIMER_HARD != 0)
+/**
+  * @brief  Export one BasicOS hard timer, whose callback runs in the tick
+  *         interrupt. The callback may only start or stop timers.
+  * @param  _name       The timer name.
+  * @param  _func       The timer callback function.
+  * @param  _oneshoot   The task is oneshoot or not.
+  * @param  para        The timer paramter.
+  * @retval None.
+  */
+#define bos_timer_export_hard(_name, _func, _oneshoot, _para)                  \
+    static bos_timer_t timer_##_name##_data;                                   \
+    BOS_USED const bos_timer_rom_t tim_##_name BOS_SECTION("timer_rom") =      \
+    {                                                                          \
+        .name = (const char *)#_name,                                          \
+        .func = _func,                                                         \
+        .oneshoot = _oneshoot,                                                 \
+        .hard = true,                                                          \
+        .parameter = _para,                                                    \
+        .data = (void *)&timer_##_name##_data,                                 \
+        .magic_head = EXPORT_ID_TIMER,                                         \
+        .magic_tail = EXPORT_ID_TIMER,                                         \
+    }
+#endif
+
+#if (BOS_TIMER_DOMAINS > 1)
+/**
+  * @brief  Export one BasicOS timer in one time domain. Its period is in the
+  *         ticks of the domain.
+  * @param  _name       The timer name.
+  * @param  _func       The timer callback function.
+  * @param  _oneshoot   The task is oneshoot or not.
+  * @param  para        The timer paramter.
+  * @param  _domain     The time domain.
+  * @retval None.
+  */
+#define bos_timer_export_domain(_name, _func, _oneshoot, _para, _domain)      \
+    static bos_timer_t timer_##_name##_data;                                   \
+    BOS_USED const bos_timer_rom_t tim_##_name BOS_SECTION("timer_rom") =      \
+    {                                                                          \
+        .name = (const char *)#_name,                                          \
+        .func = _func,                                                         \
+        .oneshoot = _oneshoot,                                                 \
+        .domain = _domain,                                                     \
+        .parameter = _para,                                                    \
+        .data = (void *)&timer_##_name##_data,                                 \
+        .magic_head = EXPORT_ID_TIMER,                                         \
+        .magic_tail = EXPORT_ID_TIMER,                                         \
+    }
+#endif
+
+#if (BOS_USE_TIMER_SLACK != 0)
+/**
+  * @brief  Export one BasicOS timer with the slack time.
+  * @param  _name       The timer name.
+  * @param  _func       The timer callback function.
+  * @param  _oneshoot   The task is oneshoot or not.
+  * @param  para        The timer paramter.
+  * @param  _slack      The time in mili-second it may expire later.
+  * @retval None.
+  */
+#define bos_timer_export_slack(_name, _func, _oneshoot, _para, _slack)        \
+    static bos_timer_t timer_##_name##_data;                                   \
+    BOS_USED const bos_timer_rom_t tim_##_name BOS_SECTION("timer_rom") =      \
+    {                                                                          \
+        .name = (const char *)#_name,                                          \
+        .func = _func,                                                         \
+        .oneshoot = _oneshoot,                                                 \
+        .parameter = _para,                                                    \
+        .data = (void *)&timer_##_name##_data,                                 \
+        .slack = (uint32_t)_slack,                                             \
+        .magic_head = EXPORT_ID_TIMER,                                         \
+        .magic_tail = EXPORT_ID_TIMER,                                         \
+    }
+#endif
+
 /* CMSIS RTOS API v2--------------------------------------------------------- */
 #define osKernelInitialize                  basic_os_init
 #define osKernelStart                       basic_os_run
@@ -266,6 +824,16 @@ void bos_timer_reset(uint16_t timer_id, uint32_t period);
 void bos_cpu_hw_init(void);
 void* bos_cpu_stack_init(bos_task_rom_t *task_info);
 void bos_cpu_trig_task_switch(void);
+#if (BOS_USE_TIME_US != 0)
+/* Free running micro-second time, it wraps around at 2^32. It is called by
+   bos_tick() once every tick, and never in the critical section. */
+uint32_t bos_cpu_time_us(void);
+#endif
+#if (BOS_USE_TICKLESS != 0)
+/* Sleep for the given ticks at most, return the passed whole ticks. It is
+   called with interrupts disabled, and returns once any interrupt is pending. */
+uint32_t bos_cpu_sleep(uint32_t ticks);
+#endif
 
 /* hook --------------------------------------------------------------------- */
 /* The idle hook function. */
@@ -277,8 +845,37 @@ void bos_hook_start(void);
 void bos_port_assert(uint32_t error_id);
 
 /* else --------------------------------------------------------------------- */
-#if (BOS_MAX_TASKS > 32)
-#error The total number of tasks in BasicOS can NOT be larger than 32 !
+#if (BOS_MAX_TASKS > 256)
+#error The total number of tasks in BasicOS can NOT be larger than 256 !
+#endif
+
+#if ((BOS_MAX_TIMERS + BOS_TIMER_POOL_SIZE) > 1023)
+#error The total number of timers in BasicOS can NOT be larger than 1023 !
+#endif
+
+#if (BOS_USE_NAME_HASH != 0)
+#if ((BOS_NAME_HASH_SIZE & (BOS_NAME_HASH_SIZE - 1)) != 0)
+#error The size of the name hash tables must be a power of two !
+#endif
+#if (BOS_NAME_HASH_SIZE <= BOS_MAX_TASKS) || (BOS_NAME_HASH_SIZE <= BOS_MAX_TIMERS)
+#error The name hash tables must be larger than the task and timer numbers !
+#endif
+#endif
+
+#if (BOS_TIMER_DOMAINS > 256) || (BOS_TIMER_DOMAINS < 1)
+#error The number of time domains in BasicOS must be 1 to 256 !
+#endif
+
+#if (BOS_MAX_PRIORITY > 255)
+#error The maximum priority in BasicOS can NOT be larger than 255 !
+#endif
+
+#if (BOS_USE_STACK_LAYOUT != 0) && (BOS_MAX_TASKS > 32)
+#error The adaptive stack layout supports 32 tasks at most !
+#endif
+
+#if (BOS_USE_EDF != 0) && (BOS_USE_MOVE_COST != 0)
+#error The move-cost policy works on task priorities, not with EDF !
 #endif
 
 #define EXPORT_ID_TASK                          (0xa5a5a5a5)
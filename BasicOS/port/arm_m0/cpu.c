@@ -34,6 +34,29 @@
 /* include ------------------------------------------------------------------ */
 #include "basic_os.h"
 
+/* macro -------------------------------------------------------------------- */
+#if (BOS_USE_TICKLESS != 0) || (BOS_USE_TIME_US != 0)
+#define SYST_CSR                        (*(uint32_t volatile *)0xE000E010)
+#define SYST_RVR                        (*(uint32_t volatile *)0xE000E014)
+#define SYST_CVR                        (*(uint32_t volatile *)0xE000E018)
+#define SYST_CSR_ENABLE                 (1U << 0)
+#define SYST_CSR_COUNTFLAG              (1U << 16)
+#define SCB_ICSR                        (*(uint32_t volatile *)0xE000ED04)
+#define SCB_ICSR_PENDSTSET              (1U << 26)
+#define SCB_ICSR_PENDSTCLR              (1U << 25)
+#endif
+
+#if (BOS_USE_TICKLESS != 0)
+#if defined(__CC_ARM)
+#define BOS_WFI()                       __wfi()
+#elif defined(__IAR_SYSTEMS_ICC__)
+#include <intrinsics.h>
+#define BOS_WFI()                       __WFI()
+#else
+#define BOS_WFI()                       __asm volatile ("wfi")
+#endif
+#endif
+
 /* public function ---------------------------------------------------------- */
 void bos_cpu_hw_init(void)
 {
@@ -78,4 +101,115 @@ void bos_cpu_trig_task_switch(void)
     *(uint32_t volatile *)0xE000ED04 = (1U << 28);
 }
 
+#if (BOS_USE_TIME_US != 0)
+/* ARMv6-M has no cycle counter, the time comes from the kernel time and the
+   SysTick current value, which counts down in the current tick. */
+uint32_t bos_cpu_time_us(void)
+{
+    uint32_t load = SYST_RVR + 1;
+    uint32_t time_ms;
+    uint32_t count;
+    bool pending;
+
+    /* Read again if one tick comes meanwhile. */
+    do
+    {
+        time_ms = bos_time();
+        count = SYST_CVR;
+        pending = ((SCB_ICSR & SCB_ICSR_PENDSTSET) != 0);
+    } while (time_ms != bos_time());
+
+    /* The counter is reloaded, but the tick is not counted yet. */
+    if (pending && count > (load / 2))
+    {
+        time_ms += BOS_TICK_MS;
+    }
+
+    return (time_ms * 1000 + (load - count) / (load / (BOS_TICK_MS * 1000)));
+}
+#endif
+
+#if (BOS_USE_TICKLESS != 0)
+/* SysTick is set to one tick per period by the user, its reload value gives
+   the cycles of one tick. It is stretched to the whole sleep, and set back to
+   the left part of the current tick at the wakeup. */
+uint32_t bos_cpu_sleep(uint32_t ticks)
+{
+    uint32_t load = SYST_RVR + 1;
+    uint32_t ticks_max = 0x00ffffffU / load;
+    ticks = ticks > ticks_max ? ticks_max : ticks;
+
+    /* Sleep to the next tick which counts itself. */
+    if (ticks < 2)
+    {
+        BOS_WFI();
+        return 0;
+    }
+
+    /* Stop SysTick, and not sleep if one tick is pending already. */
+    uint32_t csr_stop = SYST_CSR & ~(SYST_CSR_ENABLE | SYST_CSR_COUNTFLAG);
+    SYST_CSR = csr_stop;
+    if ((SCB_ICSR & SCB_ICSR_PENDSTSET) != 0)
+    {
+        SYST_CSR |= SYST_CSR_ENABLE;
+        return 0;
+    }
+
+    /* The cycles to the end of the given ticks. */
+    uint32_t remain = SYST_CVR == 0 ? load : SYST_CVR;
+    uint32_t reload = remain + (ticks - 1) * load;
+    SYST_RVR = reload - 1;
+    SYST_CVR = 0;
+    SYST_CSR |= SYST_CSR_ENABLE;
+
+    BOS_WFI();
+
+    /* Stop SysTick first, so it can not wrap between the reading of the
+       COUNTFLAG and the counter. Writing the CSR keeps the COUNTFLAG, and
+       the reading clears it. */
+    SYST_CSR = csr_stop;
+    uint32_t csr = SYST_CSR;
+    uint32_t passed = reload;
+    if ((csr & SYST_CSR_COUNTFLAG) != 0)
+    {
+        /* The whole sleep has passed, the kernel counts the last tick. */
+        SCB_ICSR = SCB_ICSR_PENDSTCLR;
+    }
+    else
+    {
+        /* Woken up by another interrupt. */
+        passed = reload - SYST_CVR;
+    }
+
+    /* Count the whole ticks and get the left part of the current tick. */
+    uint32_t ticks_passed = 0;
+    uint32_t left = remain - passed;
+    if (passed >= remain)
+    {
+        ticks_passed = 1 + (passed - remain) / load;
+        left = load - (passed - remain) % load;
+    }
+    if (left < 2)
+    {
+        ticks_passed ++;
+        left += load;
+    }
+
+    /* Run to the end of the current tick, then one tick per period again.
+       The counter is loaded from RVR at the first SysTick clock after it is
+       enabled, which may be much later with the external reference clock,
+       so RVR is set back only after the counter has been loaded. The left
+       part is 2 cycles at least, so the loaded value is not 0. */
+    SYST_RVR = left - 1;
+    SYST_CVR = 0;
+    SYST_CSR |= SYST_CSR_ENABLE;
+    while (SYST_CVR == 0)
+    {
+    }
+    SYST_RVR = load - 1;
+
+    return ticks_passed;
+}
+#endif
+
 /* ----------------------------- end of file -------------------------------- */
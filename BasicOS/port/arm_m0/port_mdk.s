@@ -100,43 +100,100 @@ PendSV_Restore
     LDR         r0, [R4]
     LDR         r4, =addr_target
     LDR         r1, [R4]
-    CMP         r1, r0              ; Check the target addr is at front of the source.
-    BHI         LoopStart_P         ; If yes, copy from front to back.
-    ADD         r0, r2              ; If not, copy from back to front.
-    ADD         r1, r2              ; Calculate the new source address.
-    SUBS        r0, r0, #4
-    SUBS        r1, r1, #4
-    
+    CMP         r1, r0              ; Check the target addr is behind the source.
+    BLS         LoopStart_P         ; If not, copy from front to back.
+                                    ; If yes, copy from back to front.
+
 LoopStart_N
-    MOV         r4, r0              ; Save the source address.
-    MOV         r5, r1              ; Save the target address.
-    MOV         r2, r2              ; Save the copying size.
-    LDR         r3, =0              ; clear counting.
-    
+    MOV         r3, r0              ; r12 = the source address + 24.
+    ADDS        r3, r3, #24
+    MOV         r12, r3
+    ADDS        r0, r0, r2          ; Start from the last 24-byte block.
+    ADDS        r1, r1, r2
+    SUBS        r0, r0, #24
+    SUBS        r1, r1, #24
+    B           Loop2_N_Check
+
 Loop2_N
-    LDR         r0, [r4]            ; Read one word from the source address.
-    STR         r0, [r5]            ; Write the word into target address.
-    ADDS        r3, r3, #4          ; Counting + 1
-    SUBS        r4, r4, #4
-    SUBS        r5, r5, #4
-    CMP         r3, r2              ; Check the end of copying.
-    BNE         Loop2_N             ; If not end, continue
+    LDMIA       r0!, {r2-r7}        ; Copy 48 bytes, the upper block first.
+    STMIA       r1!, {r2-r7}
+    SUBS        r0, r0, #48
+    SUBS        r1, r1, #48
+    LDMIA       r0!, {r2-r7}
+    STMIA       r1!, {r2-r7}
+    SUBS        r0, r0, #48
+    SUBS        r1, r1, #48
+Loop2_N_Check
+    CMP         r0, r12             ; Check two blocks are left or not.
+    BHS         Loop2_N
+    ADDS        r0, r0, #24         ; The end of the bytes left.
+    ADDS        r1, r1, #24
+    MOV         r2, r12             ; The bytes left, less than 48.
+    SUBS        r2, r0, r2
+    ADDS        r2, r2, #24
+
+Tail_N_16
+    SUBS        r2, r2, #16         ; Copy 16 bytes if they are left.
+    BCC         Tail_N_8
+    SUBS        r0, r0, #16
+    SUBS        r1, r1, #16
+    LDMIA       r0!, {r4-r7}
+    STMIA       r1!, {r4-r7}
+    SUBS        r0, r0, #16
+    SUBS        r1, r1, #16
+    B           Tail_N_16
+Tail_N_8
+    LSLS        r3, r2, #29         ; Copy 8 bytes if they are left.
+    BCC         Tail_N_4
+    SUBS        r0, r0, #8
+    SUBS        r1, r1, #8
+    LDMIA       r0!, {r4-r5}
+    STMIA       r1!, {r4-r5}
+    SUBS        r0, r0, #8
+    SUBS        r1, r1, #8
+Tail_N_4
+    LSLS        r3, r2, #30         ; Copy the last word if it is left.
+    BCC         NextTask
+    SUBS        r0, r0, #4
+    SUBS        r1, r1, #4
+    LDR         r4, [r0]
+    STR         r4, [r1]
     B           NextTask
-    
+
 LoopStart_P
-    MOV         r4, r0              ; Save the source address.
-    MOV         r5, r1              ; Save the target address.
-    MOV         r2, r2              ; Save the copying size.
-    LDR         r3, =0              ; clear counting.
-    
+    ADDS        r2, r0, r2          ; r12 = the last address of one 48-byte
+    SUBS        r2, r2, #48         ; block in the source.
+    MOV         r12, r2
+    B           Loop2_P_Check
+
 Loop2_P
-    LDR         r0, [r4]            ; Read one word from the source address.
-    STR         r0, [r5]            ; Write the word into target address.
-    ADDS        r3, r3, #4          ; Counting + 1
-    ADDS        r4, r4, #4
-    ADDS        r5, r5, #4
-    CMP         r3, r2              ; Check the end of copying.
-    BNE         Loop2_P             ; If not end, continue
+    LDMIA       r0!, {r2-r7}        ; Copy 48 bytes.
+    STMIA       r1!, {r2-r7}
+    LDMIA       r0!, {r2-r7}
+    STMIA       r1!, {r2-r7}
+Loop2_P_Check
+    CMP         r0, r12             ; Check two blocks are left or not.
+    BLS         Loop2_P
+    MOV         r2, r12             ; The bytes left, less than 48.
+    SUBS        r2, r2, r0
+    ADDS        r2, r2, #48
+
+Tail_P_16
+    SUBS        r2, r2, #16         ; Copy 16 bytes if they are left.
+    BCC         Tail_P_8
+    LDMIA       r0!, {r4-r7}
+    STMIA       r1!, {r4-r7}
+    B           Tail_P_16
+Tail_P_8
+    LSLS        r3, r2, #29         ; Copy 8 bytes if they are left.
+    BCC         Tail_P_4
+    LDMIA       r0!, {r4-r5}
+    STMIA       r1!, {r4-r5}
+Tail_P_4
+    LSLS        r3, r2, #30         ; Copy the last word if it is left.
+    BCC         NextTask
+    LDR         r4, [r0]
+    STR         r4, [r1]
 
 NextTask
     LDR         r1, = bos_next      ; sp = bos_next->sp; */
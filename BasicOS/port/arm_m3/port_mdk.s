@@ -100,9 +100,9 @@ PendSV_Restore
     LDR         r0, [R4]
     LDR         r4, =addr_target
     LDR         r1, [R4]
-    CMP         r1, r0              ; Check the target addr is at front of the source.
-    BHI         LoopStart_P         ; If yes, copy from front to back.
-    ADD         r0, r2              ; If not, copy from back to front.
+    CMP         r1, r0              ; Check the target addr is behind the source.
+    BLS         LoopStart_P         ; If not, copy from front to back.
+    ADD         r0, r2              ; If yes, copy from back to front.
     ADD         r1, r2              ; Calculate the new source address.
     SUBS        r0, r0, #4
     SUBS        r1, r1, #4
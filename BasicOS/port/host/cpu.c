@@ -0,0 +1,305 @@
+/*
+ * BasicOS V0.2
+ * Copyright (c) 2021, EventOS Team, <event-os@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the 'Software'), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS 
+ * OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+ * IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.event-os.cn
+ * https://github.com/event-os/eventos-basic
+ * https://gitee.com/event-os/eventos-basic
+ */
+
+/* The host (Linux) port, to run and test the kernel on the PC. Every task runs
+   in its own ucontext with its own host stack. The shared stack is still
+   managed by the kernel: the port keeps the frame pushed in PendSV of every
+   task in it, moves the frames as PendSV does, and checks the frames of all
+   waiting tasks after every move. The tick is given by the application, for
+   example in bos_hook_idle().
+   The kernel keeps addresses in 32 bits, so build it as non-PIE with the
+   stack in a static array, like the test in test/host. */
+
+/* include ------------------------------------------------------------------ */
+#define _XOPEN_SOURCE                   700
+#include "basic_os.h"
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+
+/* private config ----------------------------------------------------------- */
+#define HOST_TASK_STACK_SIZE            (65536)
+#define HOST_FRAME_WORDS                (16)        /* r0-r3, r12, lr, pc, xpsr,
+                                                       r4-r11 */
+#define HOST_FRAME_WORD(task)           (0xB0500000U + (task)->task_id)
+
+/* The line number given to bos_port_assert() is the one in this file. */
+#define HOST_ASSERT(test_)                                                     \
+    do                                                                         \
+    {                                                                          \
+        if (!(test_))                                                          \
+        {                                                                      \
+            bos_port_assert(__LINE__);                                         \
+        }                                                                      \
+    } while (0)
+
+/* public variables --------------------------------------------------------- */
+extern bos_task_t *volatile bos_current;
+extern bos_task_t *volatile bos_next;
+extern uint32_t addr_target;
+extern uint32_t addr_source;
+extern uint32_t copy_size;
+
+/* private variables -------------------------------------------------------- */
+static ucontext_t host_context[BOS_MAX_TASKS];
+static uint8_t host_task_stack[BOS_MAX_TASKS][HOST_TASK_STACK_SIZE];
+static bos_task_rom_t *host_task_info[BOS_MAX_TASKS];
+static uint32_t host_task_count = 0;
+static uint32_t host_sp = 0;
+static bool host_critical = false;
+
+#if (BOS_USE_TICKLESS != 0)
+static pthread_mutex_t host_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t host_cond = PTHREAD_COND_INITIALIZER;
+static bool host_interrupt = false;
+#endif
+
+/* private function --------------------------------------------------------- */
+static void host_task_entry(void);
+static void host_frame_check(bos_task_t *task);
+
+#if (BOS_USE_TICKLESS != 0) || (BOS_USE_TIME_US != 0)
+static uint64_t host_time_ns(clockid_t clock)
+{
+    struct timespec now;
+    clock_gettime(clock, &now);
+
+    return ((uint64_t)now.tv_sec * 1000000000U + (uint64_t)now.tv_nsec);
+}
+#endif
+
+/* public function ---------------------------------------------------------- */
+/**
+  * @brief  Enable the global interrupt, only one flag on the host.
+  * @retval None.
+  */
+void bos_critical_exit(void)
+{
+    host_critical = false;
+}
+
+/**
+  * @brief  Disable the global interrupt, only one flag on the host.
+  * @retval None.
+  */
+void bos_critical_enter(void)
+{
+    host_critical = true;
+}
+
+/**
+  * @brief  Get the stack top of the current task in the shared stack. The task
+  *         runs on its host stack, so it has no more frames in the shared stack
+  *         than the one pushed in PendSV.
+  * @retval The stack top.
+  */
+uint32_t get_sp_value(void)
+{
+    host_sp = (uint32_t)(uintptr_t)bos_current->stack + bos_current->stack_size * 4;
+
+    return host_sp;
+}
+
+/**
+  * @brief  The hardware initialization, nothing on the host.
+  * @retval None.
+  */
+void bos_cpu_hw_init(void)
+{
+}
+
+/**
+  * @brief  Initialize the frame of one task in the shared stack, and its host
+  *         context.
+  * @param  task_info   The task information.
+  * @retval The stack top of the task.
+  */
+void* bos_cpu_stack_init(bos_task_rom_t *task_info)
+{
+    bos_task_t *task_data = (bos_task_t *)task_info->data;
+    uint32_t *sp = (uint32_t *)((uintptr_t)task_data->stack + task_data->stack_size * 4);
+    for (uint32_t i = 0; i < HOST_FRAME_WORDS; i ++)
+    {
+        *(-- sp) = HOST_FRAME_WORD(task_data);
+    }
+
+    uint32_t id = task_data->task_id;
+    HOST_ASSERT(id < BOS_MAX_TASKS);
+    host_task_info[id] = task_info;
+    host_task_count = (id + 1) > host_task_count ? (id + 1) : host_task_count;
+    getcontext(&host_context[id]);
+    host_context[id].uc_stack.ss_sp = host_task_stack[id];
+    host_context[id].uc_stack.ss_size = HOST_TASK_STACK_SIZE;
+    host_context[id].uc_link = NULL;
+    makecontext(&host_context[id], host_task_entry, 0);
+
+    return sp;
+}
+
+/**
+  * @brief  The PendSV stand-in. It pushes the frame of the current task, moves
+  *         the shared stack, checks the frames of all tasks and then switches
+  *         to the next task. It is called in the critical section.
+  * @retval None.
+  */
+void bos_cpu_trig_task_switch(void)
+{
+    bos_task_t *task_current = bos_current;
+
+    HOST_ASSERT(host_critical);
+    if (task_current != NULL)
+    {
+        uint32_t *sp = (uint32_t *)(uintptr_t)host_sp;
+        for (uint32_t i = 0; i < HOST_FRAME_WORDS; i ++)
+        {
+            *(-- sp) = HOST_FRAME_WORD(task_current);
+        }
+    }
+    if (copy_size != 0)
+    {
+        memmove((void *)(uintptr_t)addr_target,
+                (void *)(uintptr_t)addr_source, copy_size);
+    }
+
+    bos_current = bos_next;
+    for (uint32_t i = 0; i < host_task_count; i ++)
+    {
+        host_frame_check((bos_task_t *)host_task_info[i]->data);
+    }
+
+    if (task_current == NULL)
+    {
+        setcontext(&host_context[bos_current->task_id]);
+    }
+    else if (task_current != bos_current)
+    {
+        swapcontext(&host_context[task_current->task_id],
+                    &host_context[bos_current->task_id]);
+    }
+}
+
+#if (BOS_USE_TIME_US != 0)
+/**
+  * @brief  The micro-second time from the monotonic clock of the host.
+  * @retval The micro-second time.
+  */
+uint32_t bos_cpu_time_us(void)
+{
+    return (uint32_t)(host_time_ns(CLOCK_MONOTONIC) / 1000U);
+}
+#endif
+
+#if (BOS_USE_TICKLESS != 0)
+/**
+  * @brief  Stand-in of one interrupt on the target, it ends the current
+  *         bos_cpu_sleep() at once. It can be called from other threads.
+  * @retval None.
+  */
+void bos_host_interrupt(void)
+{
+    pthread_mutex_lock(&host_mutex);
+    host_interrupt = true;
+    pthread_cond_signal(&host_cond);
+    pthread_mutex_unlock(&host_mutex);
+}
+
+/**
+  * @brief  The one-shot timer stand-in. It waits for the given ticks at most,
+  *         or until bos_host_interrupt() is called.
+  * @param  ticks   The ticks to sleep at most.
+  * @retval The passed whole ticks.
+  */
+uint32_t bos_cpu_sleep(uint32_t ticks)
+{
+    /* The condition variable waits on the real time clock. */
+    uint64_t time_start = host_time_ns(CLOCK_REALTIME);
+    uint64_t time_end = time_start + (uint64_t)ticks * BOS_TICK_MS * 1000000U;
+    struct timespec timeout =
+    {
+        .tv_sec = (time_t)(time_end / 1000000000U),
+        .tv_nsec = (long)(time_end % 1000000000U),
+    };
+
+    pthread_mutex_lock(&host_mutex);
+    while (!host_interrupt)
+    {
+        if (pthread_cond_timedwait(&host_cond, &host_mutex, &timeout) != 0)
+        {
+            break;
+        }
+    }
+    host_interrupt = false;
+    pthread_mutex_unlock(&host_mutex);
+
+    uint64_t ticks_passed = (host_time_ns(CLOCK_REALTIME) - time_start) / 1000000U / BOS_TICK_MS;
+
+    return (ticks_passed < ticks ? (uint32_t)ticks_passed : ticks);
+}
+#endif
+
+/* private function --------------------------------------------------------- */
+/**
+  * @brief  The entry of every task context. The interrupt is enabled when one
+  *         task starts, as the exception return of PendSV does. If the task
+  *         is started again after it exits, its function runs from the start.
+  * @retval None.
+  */
+static void host_task_entry(void)
+{
+    bos_task_rom_t *task_info = host_task_info[bos_current->task_id];
+
+    host_critical = false;
+    while (1)
+    {
+        task_info->func(task_info->parameter);
+        bos_task_exit();
+    }
+}
+
+/**
+  * @brief  Check the frame of one task in the shared stack. A waiting task has
+  *         nothing but its frame in its stack, and the next task has its frame
+  *         at its stack top.
+  * @param  task    The task data.
+  * @retval None.
+  */
+static void host_frame_check(bos_task_t *task)
+{
+    uint32_t *frame = (uint32_t *)task->sp;
+    uint32_t *top = (uint32_t *)((uintptr_t)task->stack + task->stack_size * 4);
+
+    HOST_ASSERT(task == bos_current || task->sp == task->stack);
+    HOST_ASSERT(top - frame >= HOST_FRAME_WORDS);
+    for (uint32_t i = 0; i < HOST_FRAME_WORDS; i ++)
+    {
+        HOST_ASSERT(frame[i] == HOST_FRAME_WORD(task));
+    }
+}
+
+/* ----------------------------- end of file -------------------------------- */
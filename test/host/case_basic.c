@@ -0,0 +1,146 @@
+/*
+ * BasicOS host test
+ * Copyright (c) 2023, EventOS Team, <event-os@outlook.com>
+ */
+
+/* The basic case for one simulated second. The tasks delay, yield, use the
+   stack and exit, and one soft timer runs. The counts are checked at the end,
+   and the task and timer IDs are found by their names. */
+
+/* include ------------------------------------------------------------------ */
+#include "host_test.h"
+
+/* private config ----------------------------------------------------------- */
+#define TEST_TIME_MS                    (1000)
+#define TEST_YIELD_LOOP                 (10)
+
+/* public variables --------------------------------------------------------- */
+const uint32_t host_case_time = TEST_TIME_MS;
+
+/* private variables -------------------------------------------------------- */
+static uint32_t count_delay = 0;
+static uint32_t count_yield_a = 0;
+static uint32_t count_yield_b = 0;
+static uint32_t count_exit = 0;
+static uint32_t count_timer = 0;
+static uint32_t count_error = 0;
+
+/* private function --------------------------------------------------------- */
+static void task_entry_delay(void *parameter);
+static void task_entry_yield(void *parameter);
+static void task_entry_exit(void *parameter);
+static void timer_callback(void *parameter);
+
+bos_task_export(delay, task_entry_delay, 3, NULL);
+bos_task_export(yield_a, task_entry_yield, 2, &count_yield_a);
+bos_task_export(yield_b, task_entry_yield, 2, &count_yield_b);
+bos_task_export(exit, task_entry_exit, 1, NULL);
+bos_timer_export(test, timer_callback, false, NULL);
+
+/* public function ---------------------------------------------------------- */
+void host_case_start(void)
+{
+    bos_timer_start(BOS_TIMER_ID(test), 5);
+}
+
+void host_case_idle(void)
+{
+}
+
+void host_case_end(void)
+{
+    printf("delay %u, yield %u %u, exit %u, timer %u, error %u.\n",
+            (unsigned)count_delay, (unsigned)count_yield_a,
+            (unsigned)count_yield_b, (unsigned)count_exit,
+            (unsigned)count_timer, (unsigned)count_error);
+    HOST_CHECK(count_delay >= (TEST_TIME_MS / 10 - 1) &&
+               count_delay <= (TEST_TIME_MS / 10 + 1));
+    HOST_CHECK(count_timer >= (TEST_TIME_MS / 5 - 1) &&
+               count_timer <= (TEST_TIME_MS / 5 + 1));
+    /* The woken yield tasks run before the next tick. */
+    HOST_CHECK(count_yield_a >= (TEST_TIME_MS - 1) * TEST_YIELD_LOOP);
+    HOST_CHECK(count_yield_a == count_yield_b);
+    HOST_CHECK(count_exit == 1);
+    HOST_CHECK(count_error == 0);
+
+    HOST_CHECK(bos_task_get_id("delay") == BOS_TASK_ID(delay));
+    HOST_CHECK(bos_task_get_id("yield_b") == BOS_TASK_ID(yield_b));
+    HOST_CHECK(bos_task_get_id("none") == BOS_NOT_FOUND);
+    HOST_CHECK(bos_timer_get_id("test") == BOS_TIMER_ID(test));
+    HOST_CHECK(bos_timer_get_id("none") == BOS_NOT_FOUND);
+}
+
+/* private function --------------------------------------------------------- */
+/* Fill one buffer in every call level and yield, the buffers have to be kept
+   when the task runs again. */
+static bool stack_fill(uint32_t depth)
+{
+    volatile uint8_t buffer[256];
+    bool ret = true;
+
+    for (uint32_t i = 0; i < sizeof(buffer); i ++)
+    {
+        buffer[i] = (uint8_t)(depth + i);
+    }
+    if (depth != 0)
+    {
+        bos_task_yield();
+        ret = stack_fill(depth - 1);
+    }
+    for (uint32_t i = 0; i < sizeof(buffer); i ++)
+    {
+        ret = ret && (buffer[i] == (uint8_t)(depth + i));
+    }
+
+    return ret;
+}
+
+static void task_entry_delay(void *parameter)
+{
+    (void)parameter;
+
+    while (1)
+    {
+        uint32_t time = bos_time();
+        count_delay ++;
+        bos_delay_ms(10);
+        if ((bos_time() - time) != 10)
+        {
+            count_error ++;
+        }
+    }
+}
+
+static void task_entry_yield(void *parameter)
+{
+    uint32_t *count = (uint32_t *)parameter;
+
+    while (1)
+    {
+        for (uint32_t i = 0; i < TEST_YIELD_LOOP; i ++)
+        {
+            (*count) ++;
+            if (!stack_fill(4))
+            {
+                count_error ++;
+            }
+        }
+        bos_delay_ms(1);
+    }
+}
+
+static void task_entry_exit(void *parameter)
+{
+    (void)parameter;
+
+    count_exit ++;
+}
+
+static void timer_callback(void *parameter)
+{
+    (void)parameter;
+
+    count_timer ++;
+}
+
+/* ----------------------------- end of file -------------------------------- */
@@ -0,0 +1,84 @@
+/*
+ * BasicOS host test
+ * Copyright (c) 2023, EventOS Team, <event-os@outlook.com>
+ */
+
+/* The time domain case. Domain 1 is ticked in the idle hook once every 4 ms,
+   as one slower low-power timer. One timer counts in the domain ticks, and
+   one timer in the kernel time runs beside it. */
+
+/* include ------------------------------------------------------------------ */
+#include "host_test.h"
+
+/* private config ----------------------------------------------------------- */
+#define TEST_TIME_MS                    (403)
+#define TEST_DOMAIN_TICK_MS             (4)
+#define TEST_PERIOD_DOMAIN              (5)
+#define TEST_PERIOD_KERNEL              (7)
+
+/* public variables --------------------------------------------------------- */
+const uint32_t host_case_time = TEST_TIME_MS;
+
+/* private variables -------------------------------------------------------- */
+static uint32_t count_domain = 0;
+static uint32_t count_kernel = 0;
+static uint32_t count_error = 0;
+
+/* private function --------------------------------------------------------- */
+static void timer_callback_domain(void *parameter);
+static void timer_callback_kernel(void *parameter);
+
+bos_timer_export_domain(domain, timer_callback_domain, false, NULL, 1);
+bos_timer_export(kernel, timer_callback_kernel, false, NULL);
+
+/* public function ---------------------------------------------------------- */
+void host_case_start(void)
+{
+    bos_timer_start(BOS_TIMER_ID(domain), TEST_PERIOD_DOMAIN);
+    bos_timer_start(BOS_TIMER_ID(kernel), TEST_PERIOD_KERNEL);
+}
+
+void host_case_idle(void)
+{
+    if ((bos_time() % TEST_DOMAIN_TICK_MS) == 0)
+    {
+        bos_tick_domain(1);
+    }
+}
+
+void host_case_end(void)
+{
+    uint32_t time_domain = TEST_TIME_MS / TEST_DOMAIN_TICK_MS;
+
+    HOST_CHECK(count_error == 0);
+    HOST_CHECK(bos_time_domain(1) == time_domain);
+    HOST_CHECK(count_domain == time_domain / TEST_PERIOD_DOMAIN);
+    HOST_CHECK(count_kernel == TEST_TIME_MS / TEST_PERIOD_KERNEL);
+}
+
+/* private function --------------------------------------------------------- */
+static void timer_callback_domain(void *parameter)
+{
+    (void)parameter;
+
+    /* In the domain time, at the same kernel time as the domain tick. */
+    count_domain ++;
+    if (bos_time_domain(1) != count_domain * TEST_PERIOD_DOMAIN ||
+        bos_time() != bos_time_domain(1) * TEST_DOMAIN_TICK_MS)
+    {
+        count_error ++;
+    }
+}
+
+static void timer_callback_kernel(void *parameter)
+{
+    (void)parameter;
+
+    count_kernel ++;
+    if (bos_time() != count_kernel * TEST_PERIOD_KERNEL)
+    {
+        count_error ++;
+    }
+}
+
+/* ----------------------------- end of file -------------------------------- */
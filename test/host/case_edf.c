@@ -0,0 +1,116 @@
+/*
+ * BasicOS host test
+ * Copyright (c) 2023, EventOS Team, <event-os@outlook.com>
+ */
+
+/* The earliest-deadline-first case. Three tasks with the relative deadlines
+   of 30, 10 and 20 ms wake up at the same time, and run in the deadline
+   order in every round. One more task with the deadline of 1 ms runs longer
+   than it, and misses its deadlines. */
+
+/* include ------------------------------------------------------------------ */
+#include "host_test.h"
+
+/* private config ----------------------------------------------------------- */
+#define TEST_TIME_MS                    (500)
+#define TEST_PERIOD                     (10)
+#define TEST_LATE_PERIOD                (15)
+#define TEST_LATE_BUSY                  (3)
+
+/* public variables --------------------------------------------------------- */
+const uint32_t host_case_time = TEST_TIME_MS;
+
+/* private data structure --------------------------------------------------- */
+typedef struct edf_test
+{
+    uint32_t deadline;
+    uint32_t order;                         /* Its place in every round */
+    uint32_t count;
+} edf_test_t;
+
+/* private variables -------------------------------------------------------- */
+static edf_test_t worker[3] =
+{
+    { 30, 2 }, { 10, 0 }, { 20, 1 },
+};
+static uint32_t round_time = 0;
+static uint32_t round_count = 0;
+static uint32_t round_place = 0;
+static uint32_t count_error = 0;
+
+/* private function --------------------------------------------------------- */
+static void task_entry_worker(void *parameter);
+static void task_entry_late(void *parameter);
+
+bos_task_export(worker_a, task_entry_worker, 2, &worker[0]);
+bos_task_export(worker_b, task_entry_worker, 2, &worker[1]);
+bos_task_export(worker_c, task_entry_worker, 2, &worker[2]);
+bos_task_export(late, task_entry_late, 2, NULL);
+
+/* public function ---------------------------------------------------------- */
+void host_case_start(void)
+{
+}
+
+void host_case_idle(void)
+{
+}
+
+void host_case_end(void)
+{
+    HOST_CHECK(count_error == 0);
+    HOST_CHECK(round_count >= TEST_TIME_MS / TEST_PERIOD / 2);
+    HOST_CHECK(worker[0].count == worker[1].count);
+    HOST_CHECK(worker[0].count == worker[2].count);
+    HOST_CHECK(bos_task_get_deadline_miss(BOS_TASK_ID(worker_a)) == 0);
+    HOST_CHECK(bos_task_get_deadline_miss(BOS_TASK_ID(worker_b)) == 0);
+    HOST_CHECK(bos_task_get_deadline_miss(BOS_TASK_ID(worker_c)) == 0);
+    HOST_CHECK(bos_task_get_deadline_miss(BOS_TASK_ID(late)) != 0);
+}
+
+/* private function --------------------------------------------------------- */
+static void task_entry_worker(void *parameter)
+{
+    edf_test_t *test = (edf_test_t *)parameter;
+
+    bos_task_set_deadline(test->deadline);
+    bos_delay_ms(TEST_PERIOD);
+
+    while (1)
+    {
+        /* One new round when the time changes. */
+        if (bos_time() != round_time)
+        {
+            if (round_place != 0 && round_place != 3)
+            {
+                count_error ++;
+            }
+            round_time = bos_time();
+            round_place = 0;
+            round_count ++;
+        }
+        if (test->order != round_place)
+        {
+            count_error ++;
+        }
+        round_place ++;
+        test->count ++;
+
+        bos_delay_ms(TEST_PERIOD);
+    }
+}
+
+static void task_entry_late(void *parameter)
+{
+    (void)parameter;
+
+    bos_task_set_deadline(1);
+
+    while (1)
+    {
+        bos_delay_ms(TEST_LATE_PERIOD);
+        host_busy(TEST_LATE_BUSY);
+    }
+}
+
+/* ----------------------------- end of file -------------------------------- */
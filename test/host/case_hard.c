@@ -0,0 +1,101 @@
+/*
+ * BasicOS host test
+ * Copyright (c) 2023, EventOS Team, <event-os@outlook.com>
+ */
+
+/* The hard timer case. One hard timer runs in bos_tick() on time, also when
+   one task runs for a long time without any switching, and starts one soft
+   timer from its callback. */
+
+/* include ------------------------------------------------------------------ */
+#include "host_test.h"
+
+/* private config ----------------------------------------------------------- */
+#define TEST_TIME_MS                    (100)
+#define TEST_PERIOD_HARD                (3)
+#define TEST_STALL_START                (50)
+#define TEST_STALL_END                  (70)
+#define TEST_FOLLOW_START               (30)
+#define TEST_FOLLOW_PERIOD              (5)
+
+/* public variables --------------------------------------------------------- */
+const uint32_t host_case_time = TEST_TIME_MS;
+
+/* private variables -------------------------------------------------------- */
+static uint32_t count_hard = 0;
+static uint32_t count_stall = 0;
+static uint32_t count_follow = 0;
+static uint32_t count_error = 0;
+
+/* private function --------------------------------------------------------- */
+static void task_entry_stall(void *parameter);
+static void timer_callback_hard(void *parameter);
+static void timer_callback_follow(void *parameter);
+
+bos_task_export(stall, task_entry_stall, 1, NULL);
+bos_timer_export_hard(hard, timer_callback_hard, false, NULL);
+bos_timer_export(follow, timer_callback_follow, true, NULL);
+
+/* public function ---------------------------------------------------------- */
+void host_case_start(void)
+{
+    bos_timer_start(BOS_TIMER_ID(hard), TEST_PERIOD_HARD);
+}
+
+void host_case_idle(void)
+{
+}
+
+void host_case_end(void)
+{
+    HOST_CHECK(count_error == 0);
+    HOST_CHECK(count_hard == (TEST_TIME_MS - 1) / TEST_PERIOD_HARD);
+    HOST_CHECK(count_stall == (TEST_STALL_END / TEST_PERIOD_HARD) -
+                              (TEST_STALL_START / TEST_PERIOD_HARD));
+    HOST_CHECK(count_follow == 1);
+}
+
+/* private function --------------------------------------------------------- */
+static void task_entry_stall(void *parameter)
+{
+    (void)parameter;
+
+    /* The hard timer runs in the ticks of the stall. */
+    bos_delay_ms(TEST_STALL_START);
+    uint32_t count = count_hard;
+    host_busy(TEST_STALL_END - TEST_STALL_START);
+    count_stall = count_hard - count;
+
+    while (1)
+    {
+        bos_delay_ms(1000);
+    }
+}
+
+static void timer_callback_hard(void *parameter)
+{
+    (void)parameter;
+
+    count_hard ++;
+    if (bos_time() != count_hard * TEST_PERIOD_HARD)
+    {
+        count_error ++;
+    }
+    if (bos_time() == TEST_FOLLOW_START)
+    {
+        bos_timer_start(BOS_TIMER_ID(follow), TEST_FOLLOW_PERIOD);
+    }
+}
+
+static void timer_callback_follow(void *parameter)
+{
+    (void)parameter;
+
+    count_follow ++;
+    if (bos_time() != TEST_FOLLOW_START + TEST_FOLLOW_PERIOD)
+    {
+        count_error ++;
+    }
+}
+
+/* ----------------------------- end of file -------------------------------- */
@@ -0,0 +1,110 @@
+/*
+ * BasicOS host test
+ * Copyright (c) 2023, EventOS Team, <event-os@outlook.com>
+ */
+
+/* The periodic task case. One task with the period of 5 ms and the phase of
+   3 ms is released on time, after its first job starts late, and no release
+   is missed. One task with the period of 10 ms has one job in every four
+   blocked for longer than the period, and every one of them misses one
+   release. */
+
+/* include ------------------------------------------------------------------ */
+#include "host_test.h"
+
+/* private config ----------------------------------------------------------- */
+#define TEST_TIME_MS                    (500)
+#define TEST_PERIOD_EXACT               (5)
+#define TEST_PHASE_EXACT                (3)
+#define TEST_START_LATE                 (6)
+#define TEST_PERIOD_LATE                (10)
+#define TEST_JOB_LONG                   (15)
+
+/* public variables --------------------------------------------------------- */
+const uint32_t host_case_time = TEST_TIME_MS;
+
+/* private variables -------------------------------------------------------- */
+static uint32_t count_exact = 0;
+static uint32_t count_late = 0;
+static uint32_t count_long = 0;
+static uint32_t wait_exact = 0;
+static uint32_t wait_late = 0;
+static uint32_t count_error = 0;
+
+/* private function --------------------------------------------------------- */
+static void task_entry_exact(void *parameter);
+static void task_entry_late(void *parameter);
+
+bos_task_export_periodic(exact, task_entry_exact, 2, NULL,
+                         TEST_PERIOD_EXACT, TEST_PHASE_EXACT);
+bos_task_export_periodic(late, task_entry_late, 1, NULL, TEST_PERIOD_LATE, 0);
+
+/* public function ---------------------------------------------------------- */
+void host_case_start(void)
+{
+}
+
+void host_case_idle(void)
+{
+}
+
+void host_case_end(void)
+{
+    bos_task_period_stat_t stat;
+
+    HOST_CHECK(count_error == 0);
+    HOST_CHECK(count_exact >= TEST_TIME_MS / TEST_PERIOD_EXACT - 2);
+
+    /* The first release is late, but no job is missed. */
+    bos_task_get_period_stat(BOS_TASK_ID(exact), &stat);
+    HOST_CHECK(stat.release_count == wait_exact);
+    HOST_CHECK(stat.release_miss == 0);
+
+    bos_task_get_period_stat(BOS_TASK_ID(late), &stat);
+    HOST_CHECK(count_long >= TEST_TIME_MS / TEST_PERIOD_LATE / 4 - 1);
+    HOST_CHECK(stat.release_count == wait_late);
+    HOST_CHECK(stat.release_miss == count_long);
+}
+
+/* private function --------------------------------------------------------- */
+static void task_entry_exact(void *parameter)
+{
+    (void)parameter;
+
+    /* The first job starts after its release. */
+    host_busy(TEST_START_LATE);
+
+    while (1)
+    {
+        /* Every wait is counted as one release, also the one not reached. */
+        wait_exact ++;
+        bos_task_wait_period();
+        count_exact ++;
+        if (count_exact > 1 &&
+            (bos_time() % TEST_PERIOD_EXACT) != TEST_PHASE_EXACT)
+        {
+            count_error ++;
+        }
+    }
+}
+
+static void task_entry_late(void *parameter)
+{
+    (void)parameter;
+
+    while (1)
+    {
+        wait_late ++;
+        bos_task_wait_period();
+        count_late ++;
+
+        /* Blocked longer than the period, as waiting for some device. */
+        if ((count_late % 4) == 0)
+        {
+            bos_delay_ms(TEST_JOB_LONG);
+            count_long ++;
+        }
+    }
+}
+
+/* ----------------------------- end of file -------------------------------- */
@@ -0,0 +1,113 @@
+/*
+ * BasicOS host test
+ * Copyright (c) 2023, EventOS Team, <event-os@outlook.com>
+ */
+
+/* The timer pool case. The pool of 4 timers is used up, and then two timers
+   are deleted and created again, as one oneshot and one periodic timer. The
+   deleted timers never run again. */
+
+/* include ------------------------------------------------------------------ */
+#include "host_test.h"
+
+/* private config ----------------------------------------------------------- */
+#define TEST_TIME_MS                    (205)
+#define TEST_DELETE                     (100)
+#define TEST_POOL_SIZE                  (4)
+
+/* public variables --------------------------------------------------------- */
+const uint32_t host_case_time = TEST_TIME_MS;
+
+/* private data structure --------------------------------------------------- */
+typedef struct timer_test
+{
+    uint32_t period;
+    uint32_t count;
+    uint32_t time_start;
+} timer_test_t;
+
+/* private variables -------------------------------------------------------- */
+static timer_test_t timer[TEST_POOL_SIZE] =
+{
+    { 10 }, { 20 }, { 30 }, { 40 },
+};
+static timer_test_t oneshot = { 5 };
+static timer_test_t periodic = { 50 };
+static uint32_t count_error = 0;
+
+/* private function --------------------------------------------------------- */
+static void task_entry_driver(void *parameter);
+static void timer_callback(void *parameter);
+
+bos_task_export(driver, task_entry_driver, 1, NULL);
+
+/* public function ---------------------------------------------------------- */
+void host_case_start(void)
+{
+}
+
+void host_case_idle(void)
+{
+}
+
+void host_case_end(void)
+{
+    HOST_CHECK(count_error == 0);
+    HOST_CHECK(timer[0].count == TEST_DELETE / timer[0].period);
+    HOST_CHECK(timer[1].count == TEST_DELETE / timer[1].period);
+    HOST_CHECK(timer[2].count == TEST_TIME_MS / timer[2].period);
+    HOST_CHECK(timer[3].count == TEST_TIME_MS / timer[3].period);
+    HOST_CHECK(oneshot.count == 1);
+    HOST_CHECK(periodic.count == (TEST_TIME_MS - TEST_DELETE) / periodic.period);
+}
+
+/* private function --------------------------------------------------------- */
+static void task_entry_driver(void *parameter)
+{
+    (void)parameter;
+
+    int16_t id[TEST_POOL_SIZE];
+    for (uint32_t i = 0; i < TEST_POOL_SIZE; i ++)
+    {
+        id[i] = bos_timer_create(timer_callback, false, &timer[i]);
+        HOST_CHECK(id[i] >= 0);
+        bos_timer_start((uint16_t)id[i], timer[i].period);
+    }
+    HOST_CHECK(bos_timer_create(timer_callback, false, &oneshot) ==
+               BOS_NO_MEMORY);
+
+    /* The deleted timers go back to the pool. */
+    bos_delay_ms(TEST_DELETE);
+    bos_timer_delete((uint16_t)id[0]);
+    bos_timer_delete((uint16_t)id[1]);
+    int16_t id_oneshot = bos_timer_create(timer_callback, true, &oneshot);
+    int16_t id_periodic = bos_timer_create(timer_callback, false, &periodic);
+    HOST_CHECK(id_oneshot >= 0 && id_periodic >= 0);
+    HOST_CHECK(id_oneshot != id_periodic);
+    HOST_CHECK(id_oneshot == id[0] || id_oneshot == id[1]);
+    HOST_CHECK(id_periodic == id[0] || id_periodic == id[1]);
+    HOST_CHECK(bos_timer_create(timer_callback, false, &oneshot) ==
+               BOS_NO_MEMORY);
+    oneshot.time_start = bos_time();
+    periodic.time_start = bos_time();
+    bos_timer_start((uint16_t)id_oneshot, oneshot.period);
+    bos_timer_start((uint16_t)id_periodic, periodic.period);
+
+    while (1)
+    {
+        bos_delay_ms(1000);
+    }
+}
+
+static void timer_callback(void *parameter)
+{
+    timer_test_t *test = (timer_test_t *)parameter;
+
+    test->count ++;
+    if (bos_time() != test->time_start + test->count * test->period)
+    {
+        count_error ++;
+    }
+}
+
+/* ----------------------------- end of file -------------------------------- */
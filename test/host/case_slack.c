@@ -0,0 +1,90 @@
+/*
+ * BasicOS host test
+ * Copyright (c) 2023, EventOS Team, <event-os@outlook.com>
+ */
+
+/* The timer slack case. One timer of 8 ms runs on time, and one of 7 ms with
+   the slack of 4 ms is moved to the multiples of 4 ms, so it shares some
+   wakeups with the first one. The saved wakeups are counted by the test in
+   the same way, and compared with the kernel. */
+
+/* include ------------------------------------------------------------------ */
+#include "host_test.h"
+
+/* private config ----------------------------------------------------------- */
+#define TEST_TIME_MS                    (300)
+#define TEST_PERIOD_EXACT               (8)
+#define TEST_PERIOD_SLACK               (7)
+#define TEST_SLACK                      (4)
+
+/* public variables --------------------------------------------------------- */
+const uint32_t host_case_time = TEST_TIME_MS;
+
+/* private variables -------------------------------------------------------- */
+static uint32_t count_exact = 0;
+static uint32_t count_slack = 0;
+static uint32_t count_shared = 0;
+static uint32_t count_error = 0;
+
+/* private function --------------------------------------------------------- */
+static void timer_callback_exact(void *parameter);
+static void timer_callback_slack(void *parameter);
+
+bos_timer_export(exact, timer_callback_exact, false, NULL);
+bos_timer_export_slack(slack, timer_callback_slack, false, NULL, TEST_SLACK);
+
+/* public function ---------------------------------------------------------- */
+void host_case_start(void)
+{
+    bos_timer_start(BOS_TIMER_ID(exact), TEST_PERIOD_EXACT);
+    bos_timer_start(BOS_TIMER_ID(slack), TEST_PERIOD_SLACK);
+}
+
+void host_case_idle(void)
+{
+}
+
+void host_case_end(void)
+{
+    HOST_CHECK(count_error == 0);
+    HOST_CHECK(count_exact >= TEST_TIME_MS / TEST_PERIOD_EXACT - 1);
+    HOST_CHECK(count_slack >= TEST_TIME_MS / TEST_PERIOD_SLACK - 1);
+    HOST_CHECK(count_shared != 0);
+    HOST_CHECK(bos_get_wakeup_saved() == count_shared);
+}
+
+/* private function --------------------------------------------------------- */
+static void timer_callback_exact(void *parameter)
+{
+    (void)parameter;
+
+    count_exact ++;
+    if (bos_time() != count_exact * TEST_PERIOD_EXACT)
+    {
+        count_error ++;
+    }
+}
+
+static void timer_callback_slack(void *parameter)
+{
+    (void)parameter;
+
+    uint32_t time = bos_time();
+    count_slack ++;
+    uint32_t expiry = count_slack * TEST_PERIOD_SLACK;
+
+    /* Later within the slack, at the multiple of the slack granule. */
+    if (time < expiry || (time - expiry) >= TEST_SLACK ||
+        (time % TEST_SLACK) != 0)
+    {
+        count_error ++;
+    }
+
+    /* One wakeup is saved when it is moved to the wakeup of the other. */
+    if (time != expiry && (time % TEST_PERIOD_EXACT) == 0)
+    {
+        count_shared ++;
+    }
+}
+
+/* ----------------------------- end of file -------------------------------- */
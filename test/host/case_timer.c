@@ -0,0 +1,212 @@
+/*
+ * BasicOS host test
+ * Copyright (c) 2023, EventOS Team, <event-os@outlook.com>
+ */
+
+/* The soft timer case. Timers with different periods run in the heap order,
+   at the multiples of their periods, and one oneshot timer runs once. Then
+   one task stalls the kernel from 100 to 135 ms, and three timers with the
+   period of 10 ms catch up in their own policies. The lateness statistics
+   are checked with BOS_USE_TIMER_STAT. */
+
+/* include ------------------------------------------------------------------ */
+#include "host_test.h"
+
+/* private config ----------------------------------------------------------- */
+#define TEST_TIME_MS                    (205)
+#define TEST_ORDER_STOP                 (95)
+#define TEST_STALL_START                (100)
+#define TEST_STALL_END                  (135)
+#define TEST_CATCHUP_PERIOD             (10)
+
+/* public variables --------------------------------------------------------- */
+const uint32_t host_case_time = TEST_TIME_MS;
+
+/* private data structure --------------------------------------------------- */
+typedef struct timer_test
+{
+    uint32_t period;
+    uint32_t count;
+    uint32_t count_stall;                   /* The runs at the stall end */
+    uint32_t time_after;                    /* The first run after it */
+} timer_test_t;
+
+/* private variables -------------------------------------------------------- */
+static timer_test_t order[] =
+{
+    { 3 }, { 4 }, { 6 }, { 7 }, { 8 }, { 9 }, { 11 }, { 12 }, { 13 }, { 14 },
+};
+static uint16_t order_id[sizeof(order) / sizeof(order[0])];
+static timer_test_t oneshot = { 7 };
+static timer_test_t catchup[3] =
+{
+    { TEST_CATCHUP_PERIOD }, { TEST_CATCHUP_PERIOD }, { TEST_CATCHUP_PERIOD },
+};
+static uint32_t time_last = 0;
+static uint32_t count_error = 0;
+
+/* private function --------------------------------------------------------- */
+static void task_entry_driver(void *parameter);
+static void timer_callback_order(void *parameter);
+static void timer_callback_oneshot(void *parameter);
+static void timer_callback_catchup(void *parameter);
+
+bos_task_export(driver, task_entry_driver, 1, NULL);
+bos_timer_export(order_0, timer_callback_order, false, &order[0]);
+bos_timer_export(order_1, timer_callback_order, false, &order[1]);
+bos_timer_export(order_2, timer_callback_order, false, &order[2]);
+bos_timer_export(order_3, timer_callback_order, false, &order[3]);
+bos_timer_export(order_4, timer_callback_order, false, &order[4]);
+bos_timer_export(order_5, timer_callback_order, false, &order[5]);
+bos_timer_export(order_6, timer_callback_order, false, &order[6]);
+bos_timer_export(order_7, timer_callback_order, false, &order[7]);
+bos_timer_export(order_8, timer_callback_order, false, &order[8]);
+bos_timer_export(order_9, timer_callback_order, false, &order[9]);
+bos_timer_export(oneshot, timer_callback_oneshot, true, &oneshot);
+bos_timer_export(catchup_all, timer_callback_catchup, false, &catchup[0]);
+bos_timer_export(catchup_skip, timer_callback_catchup, false, &catchup[1]);
+bos_timer_export(catchup_realign, timer_callback_catchup, false, &catchup[2]);
+
+/* public function ---------------------------------------------------------- */
+void host_case_start(void)
+{
+    for (uint32_t i = 0; i < sizeof(order) / sizeof(order[0]); i ++)
+    {
+        char name[] = "order_0";
+        name[6] = (char)('0' + i);
+        int16_t id = bos_timer_get_id(name);
+        HOST_CHECK(id >= 0);
+        order_id[i] = (uint16_t)id;
+        bos_timer_start(order_id[i], order[i].period);
+    }
+
+    bos_timer_set_catchup(BOS_TIMER_ID(catchup_all), BosTimerCatchup_All);
+    bos_timer_set_catchup(BOS_TIMER_ID(catchup_skip), BosTimerCatchup_Skip);
+    bos_timer_set_catchup(BOS_TIMER_ID(catchup_realign),
+                          BosTimerCatchup_Realign);
+    bos_timer_start(BOS_TIMER_ID(catchup_all), TEST_CATCHUP_PERIOD);
+    bos_timer_start(BOS_TIMER_ID(catchup_skip), TEST_CATCHUP_PERIOD);
+    bos_timer_start(BOS_TIMER_ID(catchup_realign), TEST_CATCHUP_PERIOD);
+}
+
+void host_case_idle(void)
+{
+}
+
+void host_case_end(void)
+{
+    HOST_CHECK(count_error == 0);
+    for (uint32_t i = 0; i < sizeof(order) / sizeof(order[0]); i ++)
+    {
+        HOST_CHECK(order[i].count == TEST_ORDER_STOP / order[i].period);
+    }
+    HOST_CHECK(oneshot.count == 1);
+
+    /* All runs the missed ones in a row, Skip keeps the phase, and Realign
+       counts the period from the stall end. */
+    HOST_CHECK(catchup[0].count_stall == 3);
+    HOST_CHECK(catchup[1].count_stall == 1);
+    HOST_CHECK(catchup[2].count_stall == 1);
+    HOST_CHECK(catchup[0].time_after == 140);
+    HOST_CHECK(catchup[1].time_after == 140);
+    HOST_CHECK(catchup[2].time_after == 145);
+    HOST_CHECK(catchup[0].count == 20);
+    HOST_CHECK(catchup[1].count == 18);
+    HOST_CHECK(catchup[2].count == 17);
+
+#if (BOS_USE_TIMER_STAT != 0)
+    bos_timer_stat_t stat[3];
+    bos_timer_get_stat(BOS_TIMER_ID(catchup_all), &stat[0]);
+    bos_timer_get_stat(BOS_TIMER_ID(catchup_skip), &stat[1]);
+    bos_timer_get_stat(BOS_TIMER_ID(catchup_realign), &stat[2]);
+    for (uint32_t i = 0; i < 3; i ++)
+    {
+        HOST_CHECK(stat[i].late_min == 0);
+        HOST_CHECK(stat[i].late_max == TEST_STALL_END - TEST_STALL_START - 10);
+        HOST_CHECK(stat[i].overrun == (i == 0 ? 2 : 1));
+    }
+
+    /* Late by 25, 15 and 5 ms in a row, in the buckets 5, 4 and 3. */
+    HOST_CHECK(stat[0].late_hist[0] == 17);
+    HOST_CHECK(stat[0].late_hist[1] == 0);
+    HOST_CHECK(stat[0].late_hist[2] == 0);
+    HOST_CHECK(stat[0].late_hist[3] == 1);
+    HOST_CHECK(stat[0].late_hist[4] == 1);
+    HOST_CHECK(stat[0].late_hist[5] == 1);
+    HOST_CHECK(stat[1].late_hist[5] == 1);
+
+    bos_timer_clear_stat(BOS_TIMER_ID(catchup_all));
+    bos_timer_get_stat(BOS_TIMER_ID(catchup_all), &stat[0]);
+    HOST_CHECK(stat[0].late_max == 0 && stat[0].overrun == 0);
+    HOST_CHECK(stat[0].late_hist[0] == 0 && stat[0].late_hist[5] == 0);
+#endif
+}
+
+/* private function --------------------------------------------------------- */
+static void task_entry_driver(void *parameter)
+{
+    (void)parameter;
+
+    bos_delay_ms(50);
+    bos_timer_start(BOS_TIMER_ID(oneshot), oneshot.period);
+
+    bos_delay_ms(TEST_ORDER_STOP - 50);
+    for (uint32_t i = 0; i < sizeof(order) / sizeof(order[0]); i ++)
+    {
+        bos_timer_stop(order_id[i]);
+    }
+
+    /* Stall the kernel without any switching, and the timers run late in
+       the yield. */
+    bos_delay_ms(TEST_STALL_START - TEST_ORDER_STOP);
+    host_busy(TEST_STALL_END - TEST_STALL_START);
+    bos_task_yield();
+
+    while (1)
+    {
+        bos_delay_ms(1000);
+    }
+}
+
+static void timer_callback_order(void *parameter)
+{
+    timer_test_t *test = (timer_test_t *)parameter;
+    uint32_t time = bos_time();
+
+    /* On time, and never before the last timer in the heap order. */
+    if ((time % test->period) != 0 || time < time_last)
+    {
+        count_error ++;
+    }
+    time_last = time;
+    test->count ++;
+}
+
+static void timer_callback_oneshot(void *parameter)
+{
+    timer_test_t *test = (timer_test_t *)parameter;
+
+    if (bos_time() != 50 + test->period)
+    {
+        count_error ++;
+    }
+    test->count ++;
+}
+
+static void timer_callback_catchup(void *parameter)
+{
+    timer_test_t *test = (timer_test_t *)parameter;
+    uint32_t time = bos_time();
+
+    test->count ++;
+    if (time == TEST_STALL_END)
+    {
+        test->count_stall ++;
+    }
+    else if (time > TEST_STALL_END && test->time_after == 0)
+    {
+        test->time_after = time;
+    }
+}
+
+/* ----------------------------- end of file -------------------------------- */
@@ -0,0 +1,287 @@
+/*
+ * BasicOS host test
+ * Copyright (c) 2023, EventOS Team, <event-os@outlook.com>
+ */
+
+/* The yield case, in three parts.
+   1. In the first second, three tasks with different stack depths yield to
+      each other, and one task never runs again at once after its yield while
+      another one is ready. Three tasks at a lower priority switch by
+      bos_task_yield_to(), and the given task always runs next.
+   2. After that, two tasks with the time slice of 5 ms run for a long time,
+      and yield when bos_should_yield() says so, after their time slice.
+   3. When one of them exits, bos_should_yield() keeps false for the other,
+      but for the timer service.
+   The moved bytes saved by BOS_USE_MOVE_COST, and the stack layout of
+   BOS_USE_STACK_LAYOUT are checked too. With BOS_USE_TIMER_SERVICE, the timer
+   service is woken up by bos_should_yield() and its timer runs on time. */
+
+/* include ------------------------------------------------------------------ */
+#include "host_test.h"
+
+/* private config ----------------------------------------------------------- */
+#define TEST_TIME_MS                    (2100)
+#define TEST_YIELD_END                  (1000)
+#define TEST_SLICE_END                  (1500)
+#define TEST_ALONE_START                (1600)
+#define TEST_ALONE_TIME                 (50)
+#define TEST_YIELD_LOOP                 (10)
+#define TEST_SLICE                      (5)
+#define TEST_PERIOD_TIMER               (7)
+
+/* The two-level ready bitmap is used above the priority 31. */
+#if (BOS_MAX_PRIORITY > 31)
+#define TEST_PRIO_PEER                  (35)
+#else
+#define TEST_PRIO_PEER                  (3)
+#endif
+#define TEST_PRIO_TO                    (2)
+#define TEST_PRIO_SLICE                 (1)
+
+/* public variables --------------------------------------------------------- */
+const uint32_t host_case_time = TEST_TIME_MS;
+
+/* private variables -------------------------------------------------------- */
+static const uint32_t peer_depth[3] = { 1, 3, 5 };
+static int32_t peer_last = -1;
+static uint32_t peer_active = 3;
+static uint32_t count_peer = 0;
+
+static bool to_active = false;
+static bool to_expect = false;
+static uint32_t count_yield_to = 0;
+
+static uint32_t count_slice = 0;
+static uint32_t count_slice_exact = 0;
+static uint32_t count_alone = 0;
+static uint32_t count_alone_yield = 0;
+static bool slice_exit = false;
+
+static uint32_t count_timer = 0;
+static uint32_t count_timer_late = 0;
+static uint32_t count_error = 0;
+
+/* private function --------------------------------------------------------- */
+static void task_entry_peer(void *parameter);
+static void task_entry_to_src(void *parameter);
+static void task_entry_to_dst(void *parameter);
+static void task_entry_slice(void *parameter);
+static void timer_callback(void *parameter);
+
+bos_task_export(peer_0, task_entry_peer, TEST_PRIO_PEER, (void *)0);
+bos_task_export(peer_1, task_entry_peer, TEST_PRIO_PEER, (void *)1);
+bos_task_export(peer_2, task_entry_peer, TEST_PRIO_PEER, (void *)2);
+bos_task_export(to_src, task_entry_to_src, TEST_PRIO_TO, NULL);
+bos_task_export(to_dst, task_entry_to_dst, TEST_PRIO_TO, (void *)1);
+bos_task_export(to_other, task_entry_to_dst, TEST_PRIO_TO, (void *)0);
+bos_task_export_slice(slice_a, task_entry_slice, TEST_PRIO_SLICE,
+                      (void *)1, TEST_SLICE);
+bos_task_export_slice(slice_b, task_entry_slice, TEST_PRIO_SLICE,
+                      (void *)0, TEST_SLICE);
+bos_timer_export(timer, timer_callback, false, NULL);
+
+/* public function ---------------------------------------------------------- */
+void host_case_start(void)
+{
+    bos_timer_start(BOS_TIMER_ID(timer), TEST_PERIOD_TIMER);
+}
+
+void host_case_idle(void)
+{
+}
+
+void host_case_end(void)
+{
+    HOST_CHECK(count_error == 0);
+    HOST_CHECK(count_peer >= TEST_YIELD_END * TEST_YIELD_LOOP);
+    HOST_CHECK(count_yield_to != 0);
+    HOST_CHECK(count_slice >= (TEST_SLICE_END - TEST_YIELD_END) / TEST_SLICE);
+    HOST_CHECK(count_slice_exact != 0);
+    HOST_CHECK(count_alone == TEST_ALONE_TIME);
+    HOST_CHECK(count_timer >= TEST_TIME_MS / TEST_PERIOD_TIMER - 1);
+#if (BOS_USE_TIMER_SERVICE != 0)
+    /* The timer service is woken up in bos_should_yield(), and competes with
+       the task running alone. */
+    HOST_CHECK(count_timer_late == 0);
+    HOST_CHECK(count_alone_yield != 0);
+#else
+    HOST_CHECK(count_alone_yield == 0);
+    /* The timer runs late in the long running tasks. */
+    HOST_CHECK(count_timer_late != 0);
+    HOST_CHECK(count_slice_exact == count_slice);
+#endif
+#if (BOS_USE_MOVE_COST != 0)
+    HOST_CHECK(bos_get_move_saved_size() != 0);
+#endif
+#if (BOS_USE_STACK_LAYOUT != 0)
+    bos_layout_info_t info;
+    bos_get_layout_info(&info);
+    HOST_CHECK(info.count != 0);
+#endif
+}
+
+/* private function --------------------------------------------------------- */
+/* Fill one buffer in every call level and yield, the buffers have to be kept
+   when the task runs again. */
+static bool stack_fill(uint32_t depth, int32_t peer)
+{
+    volatile uint8_t buffer[128];
+    bool ret = true;
+
+    for (uint32_t i = 0; i < sizeof(buffer); i ++)
+    {
+        buffer[i] = (uint8_t)(depth + i);
+    }
+    if (depth != 0)
+    {
+        bos_task_yield();
+
+        /* Never at once again, if another one is ready. */
+        if (peer_last == peer && peer_active > 1)
+        {
+            count_error ++;
+        }
+        peer_last = peer;
+        ret = stack_fill(depth - 1, peer);
+    }
+    for (uint32_t i = 0; i < sizeof(buffer); i ++)
+    {
+        ret = ret && (buffer[i] == (uint8_t)(depth + i));
+    }
+
+    return ret;
+}
+
+static void task_entry_peer(void *parameter)
+{
+    int32_t peer = (int32_t)(intptr_t)parameter;
+
+    while (bos_time() < TEST_YIELD_END)
+    {
+        peer_last = peer;
+        for (uint32_t i = 0; i < TEST_YIELD_LOOP; i ++)
+        {
+            count_peer ++;
+            if (!stack_fill(peer_depth[peer], peer))
+            {
+                count_error ++;
+            }
+        }
+
+        /* Not ready in the delay. */
+        peer_active --;
+        peer_last = -1;
+        bos_delay_ms(1);
+        peer_active ++;
+    }
+    peer_active --;
+}
+
+static void task_entry_to_src(void *parameter)
+{
+    (void)parameter;
+
+    while (bos_time() < TEST_YIELD_END)
+    {
+        for (uint32_t i = 0; i < TEST_YIELD_LOOP; i ++)
+        {
+            /* The given task runs next, if it is ready. */
+            to_expect = to_active;
+            bos_task_yield_to(BOS_TASK_ID(to_dst));
+        }
+        bos_delay_ms(1);
+    }
+}
+
+static void task_entry_to_dst(void *parameter)
+{
+    bool dst = (parameter != NULL);
+
+    while (bos_time() < TEST_YIELD_END)
+    {
+        if (dst)
+        {
+            to_active = true;
+        }
+        for (uint32_t i = 0; i < TEST_YIELD_LOOP; i ++)
+        {
+            bos_task_yield();
+            if (to_expect)
+            {
+                to_expect = false;
+                if (dst)
+                {
+                    count_yield_to ++;
+                }
+                else
+                {
+                    count_error ++;
+                }
+            }
+        }
+        if (dst)
+        {
+            to_active = false;
+        }
+        bos_delay_ms(1);
+    }
+}
+
+static void task_entry_slice(void *parameter)
+{
+    bool alone = (parameter != NULL);
+
+    bos_delay_ms(TEST_YIELD_END);
+
+    /* Run for a long time, and yield only after the time slice. */
+    while (bos_time() < TEST_SLICE_END || (alone && !slice_exit))
+    {
+        uint32_t time = bos_time();
+        do
+        {
+            host_busy(1);
+        } while (!bos_should_yield());
+
+        count_slice ++;
+        if ((bos_time() - time) > TEST_SLICE)
+        {
+            count_error ++;
+        }
+        else if ((bos_time() - time) == TEST_SLICE)
+        {
+            count_slice_exact ++;
+        }
+        bos_task_yield();
+    }
+    if (!alone)
+    {
+        slice_exit = true;
+        return;
+    }
+
+    /* No other task is waiting, and it keeps running. */
+    bos_delay_ms(TEST_ALONE_START - bos_time());
+    for (uint32_t i = 0; i < TEST_ALONE_TIME; i ++)
+    {
+        host_busy(1);
+        if (bos_should_yield())
+        {
+            count_alone_yield ++;
+            bos_task_yield();
+        }
+        count_alone ++;
+    }
+}
+
+static void timer_callback(void *parameter)
+{
+    (void)parameter;
+
+    count_timer ++;
+    if ((bos_time() % TEST_PERIOD_TIMER) != 0)
+    {
+        count_timer_late ++;
+    }
+}
+
+/* ----------------------------- end of file -------------------------------- */
@@ -0,0 +1,62 @@
+/*
+ * BasicOS host test
+ * Copyright (c) 2023, EventOS Team, <event-os@outlook.com>
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+/* include ------------------------------------------------------------------ */
+#include "basic_os.h"
+#include <stdio.h>
+
+/* public define ------------------------------------------------------------ */
+/* Check one condition of the test case, and record the failed one. */
+#define HOST_CHECK(test_)                                                      \
+    host_check((test_), #test_, __FILE__, __LINE__)
+
+/* public variables --------------------------------------------------------- */
+/* The test time in mili-second, given by every test case. */
+extern const uint32_t host_case_time;
+
+/* public function ---------------------------------------------------------- */
+/**
+  * @brief  Record the result of one check.
+  * @param  ok      The check is passed or not.
+  * @param  text    The checked condition.
+  * @param  file    The source file of the check.
+  * @param  line    The line of the check.
+  * @retval None.
+  */
+void host_check(bool ok, const char *text, const char *file, uint32_t line);
+
+/**
+  * @brief  Make the ticks pass in the current task without any switching, as
+  *         one task which runs for a long time.
+  * @param  ticks   The tick number.
+  * @retval None.
+  */
+void host_busy(uint32_t ticks);
+
+/* The functions given by every test case. */
+/**
+  * @brief  Start the test case, called in bos_hook_start().
+  * @retval None.
+  */
+void host_case_start(void);
+
+/**
+  * @brief  Called in the idle hook after every tick.
+  * @retval None.
+  */
+void host_case_idle(void);
+
+/**
+  * @brief  Check the results of the test case, after the test time.
+  * @retval None.
+  */
+void host_case_end(void);
+
+#endif
+
+/* ----------------------------- end of file -------------------------------- */
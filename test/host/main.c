@@ -0,0 +1,91 @@
+/*
+ * BasicOS host test
+ * Copyright (c) 2023, EventOS Team, <event-os@outlook.com>
+ */
+
+/* The runner of the host test cases. The kernel runs on the host port with
+   the tick given in the idle hook, so the time passes only when no task is
+   ready, or in host_busy(). Every test case gives its tasks and timers, and
+   checks the results after its test time. The host port checks the frames in
+   the shared stack in every switching. */
+
+/* include ------------------------------------------------------------------ */
+#include "host_test.h"
+#include <stdlib.h>
+
+/* private variables -------------------------------------------------------- */
+static uint8_t stack[4096] __attribute__((aligned(8)));
+static uint32_t count_check = 0;
+static uint32_t count_fail = 0;
+
+/* private function --------------------------------------------------------- */
+static void task_entry_host(void *parameter);
+
+/* The kernel needs one exported task at least, for the cases with timers
+   only. It runs at the lowest priority and sleeps all the time. */
+bos_task_export(host, task_entry_host, 1, NULL);
+
+/* public function ---------------------------------------------------------- */
+int main(void)
+{
+    basic_os_init(stack, sizeof(stack));
+    basic_os_run();
+
+    return 1;
+}
+
+void host_check(bool ok, const char *text, const char *file, uint32_t line)
+{
+    count_check ++;
+    if (!ok)
+    {
+        count_fail ++;
+        printf("%s:%u: check failed: %s\n", file, (unsigned)line, text);
+    }
+}
+
+void host_busy(uint32_t ticks)
+{
+    for (uint32_t i = 0; i < ticks; i ++)
+    {
+        bos_tick();
+    }
+}
+
+void bos_port_assert(uint32_t error_id)
+{
+    printf("Assert at line %u.\n", (unsigned)error_id);
+    exit(1);
+}
+
+void bos_hook_start(void)
+{
+    host_case_start();
+}
+
+void bos_hook_idle(void)
+{
+    bos_tick();
+    host_case_idle();
+    if (bos_time() < host_case_time)
+    {
+        return;
+    }
+
+    host_case_end();
+    printf("%u checks, %u failed.\n", (unsigned)count_check, (unsigned)count_fail);
+    exit(count_fail == 0 ? 0 : 1);
+}
+
+/* private function --------------------------------------------------------- */
+static void task_entry_host(void *parameter)
+{
+    (void)parameter;
+
+    while (1)
+    {
+        bos_delay_ms(1000);
+    }
+}
+
+/* ----------------------------- end of file -------------------------------- */
@@ -4,6 +4,7 @@
 #define TEST_EN_01                      (1)
 #define TEST_EN_02                      (0)
 #define TEST_EN_03                      (0)
+#define TEST_EN_04                      (0)
 
 void test_start(void);
 
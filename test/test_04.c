@@ -0,0 +1,109 @@
+#include "test.h"
+#include "basic_os.h"
+#include <stdlib.h>
+
+#if (TEST_EN_04 != 0)
+
+/* Tick-path benchmark with 32 tasks: 30 tasks sleep in bos_delay_ms() for
+   1 to 30 ms, one task reports every second, and one background task counts
+   in a yield loop. The less time is spent in waking up the sleeping tasks,
+   the larger the background count per second is. */
+#define TEST_04_TASK_SLEEP                  (30)
+
+/* The 32 tasks, and the timer service task if it is used, need the maximum
+   task number in basic_os.h to be set to 33 at least. The result is read in
+   wakeup_per_sec and background_per_sec by the debugger. */
+#if (BOS_MAX_TASKS < 32) || \
+    ((BOS_USE_TIMER_SERVICE != 0) && (BOS_MAX_TASKS < 33))
+#error Test 04 needs BOS_MAX_TASKS to be 32 at least, 33 with the timer service !
+#endif
+
+uint32_t count_wakeup = 0;
+uint32_t count_background = 0;
+uint32_t wakeup_per_sec = 0;
+uint32_t background_per_sec = 0;
+
+static void task_entry_report(void *parameter);
+static void task_entry_sleep(void *parameter);
+static void task_entry_background(void *parameter);
+
+bos_task_export(report, task_entry_report, 3, NULL);
+bos_task_export(sleep_00, task_entry_sleep, 2, (void *)1);
+bos_task_export(sleep_01, task_entry_sleep, 2, (void *)2);
+bos_task_export(sleep_02, task_entry_sleep, 2, (void *)3);
+bos_task_export(sleep_03, task_entry_sleep, 2, (void *)4);
+bos_task_export(sleep_04, task_entry_sleep, 2, (void *)5);
+bos_task_export(sleep_05, task_entry_sleep, 2, (void *)6);
+bos_task_export(sleep_06, task_entry_sleep, 2, (void *)7);
+bos_task_export(sleep_07, task_entry_sleep, 2, (void *)8);
+bos_task_export(sleep_08, task_entry_sleep, 2, (void *)9);
+bos_task_export(sleep_09, task_entry_sleep, 2, (void *)10);
+bos_task_export(sleep_10, task_entry_sleep, 2, (void *)11);
+bos_task_export(sleep_11, task_entry_sleep, 2, (void *)12);
+bos_task_export(sleep_12, task_entry_sleep, 2, (void *)13);
+bos_task_export(sleep_13, task_entry_sleep, 2, (void *)14);
+bos_task_export(sleep_14, task_entry_sleep, 2, (void *)15);
+bos_task_export(sleep_15, task_entry_sleep, 2, (void *)16);
+bos_task_export(sleep_16, task_entry_sleep, 2, (void *)17);
+bos_task_export(sleep_17, task_entry_sleep, 2, (void *)18);
+bos_task_export(sleep_18, task_entry_sleep, 2, (void *)19);
+bos_task_export(sleep_19, task_entry_sleep, 2, (void *)20);
+bos_task_export(sleep_20, task_entry_sleep, 2, (void *)21);
+bos_task_export(sleep_21, task_entry_sleep, 2, (void *)22);
+bos_task_export(sleep_22, task_entry_sleep, 2, (void *)23);
+bos_task_export(sleep_23, task_entry_sleep, 2, (void *)24);
+bos_task_export(sleep_24, task_entry_sleep, 2, (void *)25);
+bos_task_export(sleep_25, task_entry_sleep, 2, (void *)26);
+bos_task_export(sleep_26, task_entry_sleep, 2, (void *)27);
+bos_task_export(sleep_27, task_entry_sleep, 2, (void *)28);
+bos_task_export(sleep_28, task_entry_sleep, 2, (void *)29);
+bos_task_export(sleep_29, task_entry_sleep, 2, (void *)TEST_04_TASK_SLEEP);
+bos_task_export(background, task_entry_background, 1, NULL);
+
+void test_start(void)
+{
+    count_wakeup = 0;
+    count_background = 0;
+    wakeup_per_sec = 0;
+    background_per_sec = 0;
+}
+
+static void task_entry_report(void *parameter)
+{
+    (void)parameter;
+    uint32_t wakeup_last = 0;
+    uint32_t background_last = 0;
+
+    while (1)
+    {
+        bos_delay_ms(1000);
+        wakeup_per_sec = count_wakeup - wakeup_last;
+        background_per_sec = count_background - background_last;
+        wakeup_last = count_wakeup;
+        background_last = count_background;
+    }
+}
+
+static void task_entry_sleep(void *parameter)
+{
+    uint32_t period = (uint32_t)parameter;
+
+    while (1)
+    {
+        count_wakeup ++;
+        bos_delay_ms(period);
+    }
+}
+
+static void task_entry_background(void *parameter)
+{
+    (void)parameter;
+
+    while (1)
+    {
+        count_background ++;
+        bos_task_yield();
+    }
+}
+
+#endif
@@ -0,0 +1,194 @@
+# Filename: copy_cycles.py
+
+# The instruction-count model of the stack copy in the PendSV handler of the
+# Cortex-M0 port. It runs the code from PendSV_Restore to NextTask of one port
+# file on the host, checks the result with memmove, and counts the cycles by
+# the Cortex-M0 timing (zero wait state memory). The Cortex-M3 port files run
+# in it too, to check their copies, but their cycles are not the M3 ones.
+#
+# Usage: python tools/copy_cycles.py [BasicOS/port/arm_m0/port_icc.s]
+
+import re
+import sys
+
+# Cortex-M0 cycles, from the Cortex-M0 Technical Reference Manual.
+CYCLES_ALU = 1
+CYCLES_LDR_STR = 2
+CYCLES_BRANCH = 3
+CYCLES_BRANCH_NOT_TAKEN = 1
+
+ADDR_VARIABLE = {'copy_size': 0x100, 'addr_source': 0x104, 'addr_target': 0x108}
+ADDR_STACK = 0x20000000
+MASK = 0xffffffff
+
+
+def load_code(path):
+    code = []
+    labels = {}
+    running = False
+    for line in open(path, encoding = 'utf-8'):
+        line = line.split(';')[0].split('@')[0].rstrip()
+        label = re.match(r'^([A-Za-z_]\w*):?$', line)
+        if label:
+            if label.group(1) == 'PendSV_Restore':
+                running = True
+            if running:
+                labels[label.group(1)] = len(code)
+            if label.group(1) == 'NextTask':
+                break
+            continue
+        if running and line.strip() != '':
+            op, _, args = line.strip().partition(' ')
+            args = [a.strip() for a in re.split(r',(?![^{]*})', args)]
+            code.append((op.upper(), args))
+    return code, labels
+
+
+def reg_list(text):
+    regs = []
+    for part in text.strip('{}').split(','):
+        part = part.strip().lower()
+        if '-' in part:
+            start, end = part.split('-')
+            regs += ['r%d' % i for i in range(int(start[1:]), int(end[1:]) + 1)]
+        else:
+            regs.append(part)
+    return regs
+
+
+class Cpu:
+    def __init__(self, code, labels, memory):
+        self.code = code
+        self.labels = labels
+        self.mem = memory
+        self.reg = {'r%d' % i: 0 for i in range(13)}
+        self.n = self.z = self.c = self.v = False
+        self.cycles = 0
+
+    def value(self, text):
+        text = text.lower()
+        if text.startswith('#'):
+            return int(text[1:], 0)
+        return self.reg[text]
+
+    def flags(self, result, carry, overflow):
+        self.n = (result >> 31) & 1 == 1
+        self.z = result == 0
+        self.c = carry
+        self.v = overflow
+
+    def sub(self, a, b):
+        result = (a - b) & MASK
+        overflow = ((a ^ b) & (a ^ result)) >> 31 == 1
+        self.flags(result, a >= b, overflow)
+        return result
+
+    def add(self, a, b):
+        result = (a + b) & MASK
+        overflow = (~(a ^ b) & (a ^ result)) >> 31 == 1
+        self.flags(result, a + b > MASK, overflow)
+        return result
+
+    def taken(self, cond):
+        return {'': True, 'EQ': self.z, 'NE': not self.z,
+                'HI': self.c and not self.z, 'LS': not self.c or self.z,
+                'HS': self.c, 'CS': self.c, 'LO': not self.c, 'CC': not self.c,
+                'MI': self.n, 'PL': not self.n}[cond]
+
+    def run(self):
+        pc = 0
+        while pc < len(self.code):
+            op, args = self.code[pc]
+            pc += 1
+            a = [x.lower() for x in args]
+            if op == 'B' or (op[0] == 'B' and len(op) == 3):
+                if self.taken(op[1:]):
+                    pc = self.labels[args[0]]
+                    self.cycles += CYCLES_BRANCH
+                else:
+                    self.cycles += CYCLES_BRANCH_NOT_TAKEN
+                continue
+            if op in ('LDR', 'STR'):
+                self.cycles += CYCLES_LDR_STR
+                if a[1].startswith('='):
+                    name = args[1][1:].strip()
+                    self.reg[a[0]] = ADDR_VARIABLE[name] if name in ADDR_VARIABLE else int(name, 0)
+                    continue
+                base = re.findall(r'\w+|#\w+', a[1])
+                addr = self.reg[base[0]] + (int(base[1][1:], 0) if len(base) > 1 else 0)
+                if op == 'LDR':
+                    self.reg[a[0]] = self.mem[addr]
+                else:
+                    self.mem[addr] = self.reg[a[0]]
+                continue
+            if op in ('LDMIA', 'STMIA'):
+                base = a[0].rstrip('!')
+                regs = reg_list(a[1])
+                self.cycles += 1 + len(regs)
+                for r in regs:
+                    if op == 'LDMIA':
+                        self.reg[r] = self.mem[self.reg[base]]
+                    else:
+                        self.mem[self.reg[base]] = self.reg[r]
+                    self.reg[base] += 4
+                continue
+            self.cycles += CYCLES_ALU
+            if op == 'MOV':
+                self.reg[a[0]] = self.value(a[1])
+            elif op == 'CMP':
+                self.sub(self.reg[a[0]], self.value(a[1]))
+            elif op in ('ADD', 'ADDS', 'SUBS'):
+                src = a[1:] if len(a) == 3 else a
+                x, y = self.reg[src[0]], self.value(src[1])
+                if op == 'ADD':
+                    self.reg[a[0]] = (x + y) & MASK
+                elif op == 'ADDS':
+                    self.reg[a[0]] = self.add(x, y)
+                else:
+                    self.reg[a[0]] = self.sub(x, y)
+            elif op == 'LSLS':
+                x, shift = self.reg[a[1]], self.value(a[2])
+                result = (x << shift) & MASK
+                self.flags(result, (x >> (32 - shift)) & 1 == 1, self.v)
+                self.reg[a[0]] = result
+            else:
+                raise ValueError('Not supported instruction: ' + op)
+
+
+def copy(code, labels, source, target, size):
+    memory = {ADDR_STACK + i: ADDR_STACK + i for i in range(0, 0x4000, 4)}
+    memory[ADDR_VARIABLE['copy_size']] = size
+    memory[ADDR_VARIABLE['addr_source']] = source
+    memory[ADDR_VARIABLE['addr_target']] = target
+    expect = dict(memory)
+    for i in range(0, size, 4):
+        expect[target + i] = memory[source + i]
+    cpu = Cpu(code, labels, memory)
+    cpu.run()
+    return cpu.cycles, memory == expect
+
+
+def execute(path):
+    code, labels = load_code(path)
+
+    # Check the copy in both directions, with and without the overlapping.
+    errors = 0
+    for size in range(0, 200, 4):
+        for move in range(4, 232, 4):
+            for source, target in ((0x1000, 0x1000 + move), (0x1000 + move, 0x1000)):
+                source += ADDR_STACK
+                target += ADDR_STACK
+                if not copy(code, labels, source, target, size)[1]:
+                    errors += 1
+    print('%s: %d wrong copies' % (path, errors))
+
+    print('%8s %17s %17s' % ('bytes', 'forward', 'backward'))
+    for size in (64, 128, 256, 512, 1024, 4096):
+        forward = copy(code, labels, ADDR_STACK + 0x2000, ADDR_STACK + 0x1000, size)[0]
+        backward = copy(code, labels, ADDR_STACK + 0x1000, ADDR_STACK + 0x2000, size)[0]
+        print('%8d %9d %.2fB/c %9d %.2fB/c' % (size, forward, size / forward,
+                                             backward, size / backward))
+
+
+if __name__ == '__main__':
+    execute(sys.argv[1] if len(sys.argv) > 1 else 'BasicOS/port/arm_m0/port_icc.s')